@@ -0,0 +1,756 @@
+/*
+ * benchmark driver for 'make bench'
+ * prints one CSV line per measurement: ns/op and allocations/op (counted with allocator hooks)
+ * usage: ./benchmark [minimum seconds per measurement]
+ */
+#define _GNU_SOURCE /* getopt_long and clock_gettime with -ansi */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmdoptions.h"
+#include "print.h"
+
+/* getopt_long looks up long options linearly, skip it when options * tokens gets larger than this */
+#define GETOPT_LIMIT 200000000.0
+
+struct counter {
+    unsigned long allocations;
+};
+
+static void* _count_allocate(void* context, size_t size)
+{
+    ((struct counter*)context)->allocations += 1;
+    return malloc(size);
+}
+
+static void* _count_reallocate(void* context, void* ptr, size_t size)
+{
+    ((struct counter*)context)->allocations += 1;
+    return realloc(ptr, size);
+}
+
+static void _count_deallocate(void* context, void* ptr)
+{
+    (void)context;
+    free(ptr);
+}
+
+/* synthetic option definition: option i belongs to mode i % modes, mode 0 is the mode-less one */
+struct spec {
+    size_t options;
+    size_t modes;
+    char** names;
+    char** modenames;
+    char* shorts;
+    int* numargs;
+};
+
+struct arguments {
+    int argc;
+    const char** argv;
+};
+
+struct measurement {
+    double seconds;
+    unsigned long iterations;
+    unsigned long allocations;
+};
+
+static double _min_seconds = 0.2;
+
+static const char* _help_text = "synthetic option of the benchmark, this help text is long enough to be wrapped on narrow displays";
+static const char* _short_identifiers = "abcdefgijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"; /* without 'h' */
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static char* _format(const char* prefix, size_t number)
+{
+    char* str = malloc(strlen(prefix) + 24);
+    sprintf(str, "%s%lu", prefix, (unsigned long)number);
+    return str;
+}
+
+static void _create_spec(struct spec* spec, size_t options, size_t modes)
+{
+    size_t i;
+    size_t index;
+    spec->options = options;
+    spec->modes = modes;
+    spec->names = malloc(options * sizeof(*spec->names));
+    spec->shorts = malloc(options);
+    spec->numargs = malloc(options * sizeof(*spec->numargs));
+    spec->modenames = malloc(modes * sizeof(*spec->modenames));
+    for(i = 0; i < options; ++i)
+    {
+        index = i / modes; /* within the mode */
+        spec->names[i] = _format("option-", i);
+        spec->shorts[i] = index < strlen(_short_identifiers) ? _short_identifiers[index] : NO_SHORT;
+        switch(index % 4)
+        {
+            case 0:
+            case 1:
+                spec->numargs[i] = MULTI_ARGS;
+                break;
+            case 2:
+                spec->numargs[i] = SINGLE_ARG;
+                break;
+            default:
+                spec->numargs[i] = NO_ARG;
+                break;
+        }
+    }
+    spec->modenames[0] = NULL;
+    for(i = 1; i < modes; ++i)
+    {
+        spec->modenames[i] = _format("mode-", i);
+    }
+}
+
+static void _destroy_spec(struct spec* spec)
+{
+    size_t i;
+    for(i = 0; i < spec->options; ++i)
+    {
+        free(spec->names[i]);
+    }
+    for(i = 1; i < spec->modes; ++i)
+    {
+        free(spec->modenames[i]);
+    }
+    free(spec->names);
+    free(spec->shorts);
+    free(spec->numargs);
+    free(spec->modenames);
+}
+
+/* generic options only: repeated MULTI_ARGS options with values, every flag once and positional parameters */
+static void _create_arguments(struct arguments* arguments, const struct spec* spec, const char** dashed, size_t tokens)
+{
+    static const char* values[] = { "value", "another value", "/some/path/to/a/file", "42" };
+    static const char* positionals[] = { "input.txt", "output.txt", "data.csv", "-" };
+    size_t* multi = malloc(spec->options * sizeof(*multi));
+    size_t* flags = malloc(spec->options * sizeof(*flags));
+    size_t nmulti = 0;
+    size_t nflags = 0;
+    size_t i;
+    for(i = 0; i < spec->options; i += spec->modes)
+    {
+        if(spec->numargs[i] == MULTI_ARGS)
+        {
+            multi[nmulti++] = i;
+        }
+        else if(spec->numargs[i] == NO_ARG)
+        {
+            flags[nflags++] = i;
+        }
+    }
+    arguments->argv = malloc((tokens + 2) * sizeof(*arguments->argv));
+    arguments->argv[0] = "benchmark";
+    for(i = 1; i <= tokens; ++i)
+    {
+        switch(i % 4)
+        {
+            case 1:
+                arguments->argv[i] = dashed[multi[i / 4 % nmulti]];
+                break;
+            case 2:
+                arguments->argv[i] = values[i / 4 % 4];
+                break;
+            case 3: /* flags can only be given once */
+                arguments->argv[i] = i / 4 < nflags ? dashed[flags[i / 4]] : positionals[i / 4 % 4];
+                break;
+            default:
+                arguments->argv[i] = positionals[i / 4 % 4];
+                break;
+        }
+    }
+    arguments->argv[tokens + 1] = NULL;
+    arguments->argc = tokens + 1;
+    free(multi);
+    free(flags);
+}
+
+/* long identifiers as they appear on the command line */
+static const char** _dashed_names(const struct spec* spec)
+{
+    const char** names = malloc(spec->options * sizeof(*names));
+    size_t i;
+    for(i = 0; i < spec->options; ++i)
+    {
+        names[i] = _format("--option-", i);
+    }
+    return names;
+}
+
+static void _free_dashed_names(const struct spec* spec, const char** names)
+{
+    size_t i;
+    for(i = 0; i < spec->options; ++i)
+    {
+        free((char*)names[i]);
+    }
+    free((void*)names);
+}
+
+static struct cmdoptions* _define(const struct spec* spec, struct counter* counter)
+{
+    struct cmdoptions_allocator allocator;
+    struct cmdoptions* options;
+    size_t i;
+    allocator.allocate = _count_allocate;
+    allocator.reallocate = _count_reallocate;
+    allocator.deallocate = _count_deallocate;
+    allocator.context = counter;
+    options = cmdoptions_create_with_allocator(&allocator);
+    for(i = 1; i < spec->modes; ++i)
+    {
+        cmdoptions_add_mode(options, spec->modenames[i]);
+    }
+    for(i = 0; i < spec->options; ++i)
+    {
+        if(i % spec->modes)
+        {
+            cmdoptions_mode_add_option(options, spec->modenames[i % spec->modes], spec->shorts[i], spec->names[i], spec->numargs[i], _help_text);
+        }
+        else
+        {
+            cmdoptions_add_option(options, spec->shorts[i], spec->names[i], spec->numargs[i], _help_text);
+        }
+    }
+    if(!cmdoptions_is_valid(options))
+    {
+        fprintf(stderr, "benchmark: definition failed\n");
+        exit(1);
+    }
+    return options;
+}
+
+static void _report(const char* benchmark, const struct spec* spec, size_t tokens, const struct measurement* measurement, double ops, int count_allocations)
+{
+    double total = ops * measurement->iterations;
+    printf("%s,%lu,%lu,%lu,%lu,%.1f,", benchmark, (unsigned long)spec->options, (unsigned long)spec->modes, (unsigned long)tokens,
+        measurement->iterations, measurement->seconds * 1e9 / total);
+    if(count_allocations)
+    {
+        printf("%.2f\n", measurement->allocations / total);
+    }
+    else
+    {
+        printf("n/a\n");
+    }
+    fflush(stdout);
+}
+
+static int _done(const struct measurement* measurement)
+{
+    return measurement->seconds >= _min_seconds;
+}
+
+static void _bench_define(const struct spec* spec)
+{
+    struct measurement measurement = { 0.0, 0, 0 };
+    struct counter counter;
+    struct cmdoptions* options;
+    double start;
+    while(!_done(&measurement))
+    {
+        counter.allocations = 0;
+        start = _now();
+        options = _define(spec, &counter);
+        measurement.seconds += _now() - start;
+        measurement.allocations += counter.allocations;
+        measurement.iterations += 1;
+        cmdoptions_destroy(options);
+    }
+    _report("add_option", spec, 0, &measurement, spec->options, 1);
+}
+
+static void _bench_parse(const struct spec* spec, const struct arguments* arguments)
+{
+    struct measurement measurement = { 0.0, 0, 0 };
+    struct counter counter;
+    struct cmdoptions* options;
+    double start;
+    while(!_done(&measurement))
+    {
+        options = _define(spec, &counter);
+        counter.allocations = 0;
+        start = _now();
+        if(!cmdoptions_parse(options, arguments->argc, arguments->argv) || !cmdoptions_is_valid(options))
+        {
+            fprintf(stderr, "benchmark: parsing failed\n");
+            exit(1);
+        }
+        measurement.seconds += _now() - start;
+        measurement.allocations += counter.allocations;
+        measurement.iterations += 1;
+        cmdoptions_destroy(options);
+    }
+    _report("parse", spec, arguments->argc - 1, &measurement, 1, 1);
+}
+
+/* the same definition parses every command line, cmdoptions_reset in between */
+static void _bench_reparse(const struct spec* spec, const struct arguments* arguments)
+{
+    struct measurement measurement = { 0.0, 0, 0 };
+    struct counter counter;
+    struct cmdoptions* options = _define(spec, &counter);
+    double start;
+    while(!_done(&measurement))
+    {
+        counter.allocations = 0;
+        start = _now();
+        if(!cmdoptions_parse(options, arguments->argc, arguments->argv) || !cmdoptions_is_valid(options))
+        {
+            fprintf(stderr, "benchmark: parsing failed\n");
+            exit(1);
+        }
+        cmdoptions_reset(options);
+        measurement.seconds += _now() - start;
+        measurement.allocations += counter.allocations;
+        measurement.iterations += 1;
+    }
+    cmdoptions_destroy(options);
+    _report("reparse", spec, arguments->argc - 1, &measurement, 1, 1);
+}
+
+/* the arguments as one command line, values with spaces are quoted */
+static char* _join_arguments(const struct arguments* arguments, size_t* length)
+{
+    size_t size = 1;
+    char* str;
+    char* end;
+    int i;
+    for(i = 1; i < arguments->argc; ++i)
+    {
+        size += strlen(arguments->argv[i]) + 3;
+    }
+    str = malloc(size);
+    end = str;
+    for(i = 1; i < arguments->argc; ++i)
+    {
+        int quote = strchr(arguments->argv[i], ' ') != NULL;
+        size_t len = strlen(arguments->argv[i]);
+        if(i > 1)
+        {
+            *end++ = ' ';
+        }
+        if(quote)
+        {
+            *end++ = '"';
+        }
+        memcpy(end, arguments->argv[i], len);
+        end += len;
+        if(quote)
+        {
+            *end++ = '"';
+        }
+    }
+    *end = 0;
+    *length = end - str;
+    return str;
+}
+
+/* what callers do without cmdoptions_parse_string: split at whitespace (honoring double quotes) and copy every word into a growing argv */
+static const char** _split(const char* str, int* argc, struct counter* counter)
+{
+    size_t capacity = 16;
+    const char** argv = malloc(capacity * sizeof(*argv));
+    counter->allocations += 1;
+    argv[0] = "benchmark";
+    *argc = 1;
+    while(1)
+    {
+        const char* begin;
+        char* word;
+        while(*str == ' ')
+        {
+            ++str;
+        }
+        if(!*str)
+        {
+            break;
+        }
+        if(*str == '"')
+        {
+            begin = ++str;
+            while(*str && *str != '"')
+            {
+                ++str;
+            }
+        }
+        else
+        {
+            begin = str;
+            while(*str && *str != ' ')
+            {
+                ++str;
+            }
+        }
+        if((size_t)*argc + 1 >= capacity)
+        {
+            capacity *= 2;
+            argv = realloc((void*)argv, capacity * sizeof(*argv));
+            counter->allocations += 1;
+        }
+        word = malloc(str - begin + 1);
+        counter->allocations += 1;
+        memcpy(word, begin, str - begin);
+        word[str - begin] = 0;
+        argv[(*argc)++] = word;
+        if(*str == '"')
+        {
+            ++str;
+        }
+    }
+    argv[*argc] = NULL;
+    return argv;
+}
+
+static void _free_split(int argc, const char** argv)
+{
+    int i;
+    for(i = 1; i < argc; ++i)
+    {
+        free((char*)argv[i]);
+    }
+    free((void*)argv);
+}
+
+/* cmdoptions_parse_string on a copy of the command line (it is split in place), with borrowed arguments */
+static void _bench_parse_string(const struct spec* spec, const struct arguments* arguments, const char* line, size_t length)
+{
+    struct measurement measurement = { 0.0, 0, 0 };
+    struct counter counter;
+    struct cmdoptions* options = _define(spec, &counter);
+    char* buffer = malloc(length + 1);
+    double start;
+    cmdoptions_enable_borrowed_arguments(options);
+    while(!_done(&measurement))
+    {
+        counter.allocations = 0;
+        start = _now();
+        memcpy(buffer, line, length + 1);
+        if(!cmdoptions_parse_string(options, buffer) || !cmdoptions_is_valid(options))
+        {
+            fprintf(stderr, "benchmark: parsing failed\n");
+            exit(1);
+        }
+        cmdoptions_reset(options);
+        measurement.seconds += _now() - start;
+        measurement.allocations += counter.allocations;
+        measurement.iterations += 1;
+    }
+    free(buffer);
+    cmdoptions_destroy(options);
+    _report("parse_string", spec, arguments->argc - 1, &measurement, 1, 1);
+}
+
+/* baseline for parse_string: _split and cmdoptions_parse with the same settings */
+static void _bench_split_parse(const struct spec* spec, const struct arguments* arguments, const char* line)
+{
+    struct measurement measurement = { 0.0, 0, 0 };
+    struct counter counter;
+    struct cmdoptions* options = _define(spec, &counter);
+    const char** argv;
+    int argc;
+    double start;
+    cmdoptions_enable_borrowed_arguments(options);
+    while(!_done(&measurement))
+    {
+        counter.allocations = 0;
+        start = _now();
+        argv = _split(line, &argc, &counter);
+        if(!cmdoptions_parse(options, argc, argv) || !cmdoptions_is_valid(options))
+        {
+            fprintf(stderr, "benchmark: parsing failed\n");
+            exit(1);
+        }
+        cmdoptions_reset(options);
+        _free_split(argc, argv);
+        measurement.seconds += _now() - start;
+        measurement.allocations += counter.allocations;
+        measurement.iterations += 1;
+    }
+    cmdoptions_destroy(options);
+    _report("split_parse", spec, arguments->argc - 1, &measurement, 1, 1);
+}
+
+static void _bench_getopt_long(const struct spec* spec, const struct arguments* arguments)
+{
+    struct measurement measurement = { 0.0, 0, 0 };
+    struct option* longopts = malloc((spec->options / spec->modes + 1) * sizeof(*longopts));
+    char* shortopts = malloc(3 * strlen(_short_identifiers) + 3);
+    char** argv = malloc((arguments->argc + 1) * sizeof(*argv));
+    size_t n = 0;
+    size_t s = 0;
+    size_t i;
+    unsigned long found;
+    double start;
+    shortopts[s++] = '-'; /* positional parameters are returned in order, otherwise argv is permuted (quadratic) */
+    shortopts[s++] = ':'; /* report missing arguments as ':' */
+    for(i = 0; i < spec->options; i += spec->modes)
+    {
+        longopts[n].name = spec->names[i];
+        longopts[n].has_arg = spec->numargs[i] ? required_argument : no_argument;
+        longopts[n].flag = NULL;
+        longopts[n].val = spec->shorts[i] ? spec->shorts[i] : 256 + (int)n;
+        if(spec->shorts[i])
+        {
+            shortopts[s++] = spec->shorts[i];
+            if(spec->numargs[i])
+            {
+                shortopts[s++] = ':';
+            }
+        }
+        ++n;
+    }
+    longopts[n].name = NULL;
+    longopts[n].has_arg = 0;
+    longopts[n].flag = NULL;
+    longopts[n].val = 0;
+    shortopts[s] = 0;
+    opterr = 0;
+    while(!_done(&measurement))
+    {
+        memcpy(argv, arguments->argv, (arguments->argc + 1) * sizeof(*argv)); /* getopt_long takes non-const strings */
+        found = 0;
+        start = _now();
+        optind = 0; /* full re-initialization */
+        while(getopt_long(arguments->argc, argv, shortopts, longopts, NULL) != -1)
+        {
+            ++found;
+        }
+        measurement.seconds += _now() - start;
+        measurement.iterations += 1;
+        if(found == 0)
+        {
+            fprintf(stderr, "benchmark: getopt_long found no options\n");
+            exit(1);
+        }
+    }
+    _report("getopt_long", spec, arguments->argc - 1, &measurement, 1, 0);
+    free(longopts);
+    free(shortopts);
+    free(argv);
+}
+
+static void _bench_query(const struct spec* spec, const struct arguments* arguments)
+{
+    struct measurement measurement = { 0.0, 0, 0 };
+    struct counter counter;
+    struct cmdoptions* options = _define(spec, &counter);
+    size_t queries = 100000;
+    size_t q;
+    size_t i;
+    size_t checksum = 0;
+    double start;
+    cmdoptions_parse(options, arguments->argc, arguments->argv);
+    while(!_done(&measurement))
+    {
+        counter.allocations = 0;
+        start = _now();
+        for(q = 0; q < queries; ++q)
+        {
+            i = q * 7919 % spec->options;
+            if(i % spec->modes)
+            {
+                checksum += cmdoptions_mode_was_provided_long(options, spec->modenames[i % spec->modes], spec->names[i]);
+            }
+            else
+            {
+                switch(q % 4)
+                {
+                    case 0:
+                        checksum += cmdoptions_was_provided_long(options, spec->names[i]);
+                        break;
+                    case 1:
+                        checksum += cmdoptions_get_argument_long(options, spec->names[i]) != NULL;
+                        break;
+                    case 2:
+                        checksum += cmdoptions_get_argument_count_long(options, spec->names[i]);
+                        break;
+                    default:
+                        checksum += cmdoptions_was_provided_short(options, _short_identifiers[q % strlen(_short_identifiers)]);
+                        break;
+                }
+            }
+        }
+        measurement.seconds += _now() - start;
+        measurement.allocations += counter.allocations;
+        measurement.iterations += 1;
+    }
+    cmdoptions_destroy(options);
+    if(checksum == 0)
+    {
+        fprintf(stderr, "benchmark: no option was found\n");
+    }
+    _report("query", spec, arguments->argc - 1, &measurement, queries, 1);
+}
+
+static void _discard(void* userdata, const char* data, size_t size)
+{
+    (void)data;
+    *(size_t*)userdata += size;
+}
+
+static void _bench_output(const struct spec* spec, int manpage)
+{
+    struct measurement measurement = { 0.0, 0, 0 };
+    struct counter counter;
+    struct cmdoptions* options = _define(spec, &counter);
+    struct print_sink sink;
+    size_t written = 0;
+    double start;
+    while(!_done(&measurement))
+    {
+        counter.allocations = 0;
+        start = _now();
+        print_sink_init_callback(&sink, _discard, &written);
+        print_sink_set_allocator(&sink, _count_reallocate, _count_deallocate, &counter);
+        if(manpage)
+        {
+            cmdoptions_export_manpage_sink(options, &sink);
+        }
+        else
+        {
+            cmdoptions_help_sink(options, &sink);
+        }
+        print_sink_flush(&sink);
+        print_sink_release(&sink);
+        measurement.seconds += _now() - start;
+        measurement.allocations += counter.allocations;
+        measurement.iterations += 1;
+    }
+    cmdoptions_destroy(options);
+    _report(manpage ? "export_manpage" : "help", spec, 0, &measurement, 1, 1);
+}
+
+/* one paragraph of about size bytes, with non-ASCII words (2-byte, wide and combining characters) or without */
+static char* _create_corpus(size_t size, int utf8)
+{
+    static const char* ascii[] = { "option", "argument", "the", "parser", "is", "wrapped", "at", "columns" };
+    static const char* mixed[] = { "option", "r\xc3\xa9sum\xc3\xa9", "\xe5\xbc\x95\xe6\x95\xb0", "the", "e\xcc\x81te\xcc\x81", "\xd0\xb0\xd1\x80\xd0\xb3\xd1\x83\xd0\xbc\xd0\xb5\xd0\xbd\xd1\x82", "\xe3\x82\xaa\xe3\x83\x97\xe3\x82\xb7\xe3\x83\xa7\xe3\x83\xb3", "columns" };
+    const char** words = utf8 ? mixed : ascii;
+    char* corpus = malloc(size + 32);
+    size_t length = 0;
+    size_t i = 0;
+    while(length < size)
+    {
+        strcpy(corpus + length, words[i++ % 8]);
+        length += strlen(corpus + length);
+        corpus[length++] = ' ';
+    }
+    corpus[length - 1] = '\0';
+    return corpus;
+}
+
+static void _bench_wrap(size_t size, int utf8)
+{
+    struct measurement measurement = { 0.0, 0, 0 };
+    struct counter counter;
+    struct spec spec;
+    struct print_sink sink;
+    char* corpus = _create_corpus(size, utf8);
+    size_t length = strlen(corpus);
+    size_t written = 0;
+    double start;
+    memset(&spec, 0, sizeof(spec));
+    while(!_done(&measurement))
+    {
+        counter.allocations = 0;
+        start = _now();
+        print_sink_init_callback(&sink, _discard, &written);
+        print_sink_set_allocator(&sink, _count_reallocate, _count_deallocate, &counter);
+        print_wrapped_paragraph_sink(&sink, corpus, 80, 0);
+        print_sink_flush(&sink);
+        print_sink_release(&sink);
+        measurement.seconds += _now() - start;
+        measurement.allocations += counter.allocations;
+        measurement.iterations += 1;
+    }
+    free(corpus);
+    /* per byte of text, the token column holds the size of the corpus */
+    _report(utf8 ? "wrap_utf8" : "wrap_ascii", &spec, length, &measurement, length, 1);
+}
+
+static void _bench_destroy(const struct spec* spec, const struct arguments* arguments)
+{
+    struct measurement measurement = { 0.0, 0, 0 };
+    struct counter counter;
+    struct cmdoptions* options;
+    double start;
+    while(!_done(&measurement))
+    {
+        options = _define(spec, &counter);
+        cmdoptions_parse(options, arguments->argc, arguments->argv);
+        counter.allocations = 0;
+        start = _now();
+        cmdoptions_destroy(options);
+        measurement.seconds += _now() - start;
+        measurement.allocations += counter.allocations;
+        measurement.iterations += 1;
+    }
+    _report("destroy", spec, arguments->argc - 1, &measurement, 1, 1);
+}
+
+int main(int argc, char** argv)
+{
+    static const size_t specs[][2] = { { 10, 1 }, { 1000, 1 }, { 1000, 50 }, { 10000, 1 }, { 10000, 500 } };
+    static const size_t tokens[] = { 1000, 100000, 1000000 };
+    struct spec spec;
+    struct arguments arguments;
+    const char** dashed;
+    char* line;
+    size_t length;
+    size_t s;
+    size_t t;
+    if(argc > 1)
+    {
+        _min_seconds = atof(argv[1]);
+    }
+    print_set_screen_width(120); /* independent of the terminal */
+    printf("benchmark,options,modes,tokens,iterations,ns_per_op,allocations_per_op\n");
+    for(s = 0; s < sizeof(specs) / sizeof(*specs); ++s)
+    {
+        _create_spec(&spec, specs[s][0], specs[s][1]);
+        dashed = _dashed_names(&spec);
+        _bench_define(&spec);
+        for(t = 0; t < sizeof(tokens) / sizeof(*tokens); ++t)
+        {
+            _create_arguments(&arguments, &spec, dashed, tokens[t]);
+            _bench_parse(&spec, &arguments);
+            _bench_reparse(&spec, &arguments);
+            line = _join_arguments(&arguments, &length);
+            _bench_parse_string(&spec, &arguments, line, length);
+            _bench_split_parse(&spec, &arguments, line);
+            free(line);
+            if((double)(spec.options / spec.modes) * tokens[t] <= GETOPT_LIMIT)
+            {
+                _bench_getopt_long(&spec, &arguments);
+            }
+            if(t == 0)
+            {
+                _bench_query(&spec, &arguments);
+                _bench_destroy(&spec, &arguments);
+            }
+            free((void*)arguments.argv);
+        }
+        _bench_output(&spec, 0);
+        _bench_output(&spec, 1);
+        _free_dashed_names(&spec, dashed);
+        _destroy_spec(&spec);
+    }
+    _bench_wrap(4 << 20, 0);
+    _bench_wrap(4 << 20, 1);
+    return 0;
+}
@@ -1,25 +1,71 @@
+#if defined(CMDOPTIONS_ENABLE_MMAP) || defined(CMDOPTIONS_ENABLE_THREADS)
+#define _DEFAULT_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "cmdoptions.h"
 
 #include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#ifdef CMDOPTIONS_ENABLE_STATS
+#include <time.h>
+#endif
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+#ifdef CMDOPTIONS_ENABLE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef CMDOPTIONS_ENABLE_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
 #include "print.h"
 
+/* converted argument of a typed option */
+union typed_value {
+    long int_value;
+    unsigned long uint_value;
+    double double_value; /* also durations */
+    int bool_value;
+    size_t size_value;
+};
+
 struct option {
     char short_identifier;
     const char* long_identifier;
+    size_t long_length; /* strlen(long_identifier), used by the help layout */
     int numargs;
-    void* argument; /* is char* for once-only options, char** (with NULL terminator) for multiple options */
-    int was_provided;
-    int was_checked;
+    void* default_argument; /* same layout as the argument, returned as long as the option was not provided */
+    int default_static; /* strings of default_argument are not owned */
+    union typed_value default_value; /* typed options: converted default_argument, returned instead of it */
+    int checked; /* exempt from cmdoptions_assert_all_options_checked */
     const char* help;
     struct option* aliased;
+    size_t id; /* index of the option state in a parse result */
+};
+
+/* per-parse state of an option, the definition is never written while parsing */
+struct option_state {
+    void* argument; /* is char* for once-only options, char** (with NULL terminator) for multiple options, an array of values for typed multiple options */
+    union typed_value value; /* typed once-only options, argument is not used */
+    size_t argument_size; /* multiple options: number of arguments (without the sentinel) */
+    size_t argument_capacity; /* multiple options: allocated entries (with the sentinel) */
+    int argument_borrowed; /* strings of argument point into argv */
+    int was_provided;
+    int was_checked;
+    const struct option* next_provided; /* list of the options provided since the last reset */
 };
 
 struct section {
     char* name;
+    int name_static; /* name is not owned */
 };
 
 struct entry {
@@ -27,1258 +73,5335 @@ struct entry {
     enum { SECTION, OPTION } what;
 };
 
+struct index_slot {
+    const char* key;
+    void* value;
+};
+
+struct index {
+    struct index_slot* slots; /* open addressing, capacity is a power of two */
+    size_t size;
+    size_t capacity;
+};
+
 struct mode {
     char* identifier;
+    int identifier_static; /* identifier is not owned */
     struct entry** entries;
     size_t entries_size;
     size_t entries_capacity;
+    struct option* short_index[256]; /* direct table, indexed by the short identifier */
+    struct index long_index; /* long identifier -> struct option*, aliases are already resolved */
+    const struct cmdoptions_static_mode* table; /* generated lookup tables, searched before the indices above */
+    struct entry* static_entries; /* entries created from the table, in table order */
+    size_t id; /* index in the modes of the structure and of the mode state in a parse result */
+};
+
+struct mode_state {
     int was_selected;
+    const struct mode* next_selected; /* list of the modes selected since the last reset */
+};
+
+/* arena block, the data follows the (aligned) header */
+struct arena_block {
+    struct arena_block* next;
+    size_t size;
+    size_t used;
+    size_t last; /* offset of the most recent allocation, this one can grow and shrink in place */
+};
+
+/* content of a response file, either mapped or read into memory */
+struct response_file {
+    char* data; /* NUL-terminated, tokenized in place */
+    size_t size;
+    int mapped;
+    struct response_file* next;
+};
+
+/*
+ * everything a parse writes, so a frozen definition can be shared by several results
+ * every structure has a built-in result, which is used by cmdoptions_parse and the query functions without result
+ */
+struct cmdoptions_result {
+    const struct cmdoptions* options;
+    struct cmdoptions* owner; /* set for the built-in result, which allocates like its structure */
+    struct cmdoptions_allocator allocator; /* otherwise, everything is allocated here */
+    struct option_state* states; /* indexed by option ID */
+    size_t states_capacity;
+    struct mode_state* modes; /* indexed by mode ID */
+    size_t modes_capacity;
+    const struct option* provided; /* head of the provided options, cleared by a reset */
+    const struct mode* selected; /* head of the selected modes (without basemode) */
+    char** positional_parameters; /* NULL-terminated */
+    size_t positional_parameters_size; /* without the sentinel */
+    size_t positional_parameters_capacity; /* with the sentinel */
+    int positional_parameters_borrowed;
+    struct response_file* response_files; /* kept alive because arguments were borrowed from them */
+    int help_passed;
+    int valid;
+#ifdef CMDOPTIONS_ENABLE_STATS
+    struct cmdoptions_stats stats; /* parses and queries, unless the result is built in */
+#endif
 };
 
 struct cmdoptions {
     struct mode** modes; /* first 'mode' is mode-less */
     size_t size;
     size_t capacity;
-    char** positional_parameters;
+    struct index mode_index; /* mode identifier -> struct mode* (without basemode) */
+    size_t noptions; /* number of created options, the ID of the next one */
+    int frozen; /* see cmdoptions_freeze */
+    struct cmdoptions_result* result; /* built-in result */
     char* prehelpmsg;
     char* posthelpmsg;
     int force_narrow_mode;
+    size_t optwidth; /* width of the widest option column of all modes, updated when options are added */
+    int borrow_arguments;
+    int static_strings;
+    int expand_response_files;
     int valid;
-    int help_passed;
+    int marked; /* state recorded when the first parse after the definition started */
+    int mark_valid;
+    struct arena_block* mark_block; /* arena position, everything allocated after it belongs to parses */
+    size_t mark_used;
+    size_t mark_last;
+    char** mark_positional;
+    size_t mark_positional_capacity;
+    struct cmdoptions_allocator allocator;
+    struct arena_block* arena; /* NULL if every allocation goes directly to the allocator */
+    const struct cmdoptions_static_table* table; /* set by cmdoptions_create_static */
+    struct entry* static_entries; /* all entries of the table, indexed by option ID */
+    const struct cmdoptions_static_help* static_help; /* pre-rendered help messages, dropped as soon as the definition changes */
+    size_t static_help_size;
+    const char* static_manpage;
+    struct cmdoptions_static_table* snapshot_table; /* owned table of a loaded snapshot, points into the snapshot */
+    char* snapshot;
+    size_t snapshot_size;
+    int snapshot_mapped;
+#ifdef CMDOPTIONS_ENABLE_STATS
+    struct cmdoptions_stats stats;
+    size_t mark_heap_size;
+#endif
 };
 
-struct cmdoptions* cmdoptions_create_no_help(void)
+/*
+ * instrumentation, the counters are also updated through const pointers
+ * parses and queries of a result count into the result (the built-in one into its structure), so threads that
+ * share a frozen definition never write the same counters
+ */
+#ifdef CMDOPTIONS_ENABLE_STATS
+#define _STATS(options) (&((struct cmdoptions*)(options))->stats)
+#define _RESULT_STATS(result) ((result)->owner ? &(result)->owner->stats : &((struct cmdoptions_result*)(result))->stats)
+#define _STATS_ADD(stats, counter, n) ((stats)->counter += (n))
+#define _STATS_LOOKUP(stats, found) ((stats)->lookups += 1, (found) ? ((stats)->lookup_hits += 1) : ((stats)->lookup_misses += 1))
+#define _STATS_TIMER(start) clock_t start;
+#define _STATS_START(start) ((start) = clock())
+#define _STATS_STOP(stats, counter, timer, start) ((stats)->counter += 1, (stats)->timer += (double)(clock() - (start)) / CLOCKS_PER_SEC)
+#else
+#define _STATS(options) ((void)(options), (struct cmdoptions_stats*)NULL)
+#define _RESULT_STATS(result) ((void)(result), (struct cmdoptions_stats*)NULL)
+#define _STATS_ADD(stats, counter, n) ((void)(stats))
+#define _STATS_LOOKUP(stats, found) ((void)(stats))
+#define _STATS_TIMER(start)
+#define _STATS_START(start) ((void)0)
+#define _STATS_STOP(stats, counter, timer, start) ((void)(stats))
+#endif
+
+/* memory handling */
+static void* _default_allocate(void* context, size_t size)
 {
-    struct cmdoptions* options = malloc(sizeof(*options));
-    struct mode* basemode = malloc(sizeof(*basemode));
-    basemode->identifier = NULL;
-    basemode->entries_size = 0;
-    basemode->entries_capacity = 1;
-    basemode->entries = malloc(basemode->entries_capacity * sizeof(*basemode->entries));
-    basemode->was_selected = 1; /* basemode is always selected */
-    options->modes = malloc(sizeof(*options->modes));
-    options->modes[0] = basemode;
-    options->size = 1;
-    options->capacity = 1;
-    options->positional_parameters = malloc(sizeof(*options->positional_parameters));;
-    *options->positional_parameters = NULL; /* sentinel */
-    options->prehelpmsg = malloc(1);
-    options->prehelpmsg[0] = 0;
-    options->posthelpmsg = malloc(1);
-    options->posthelpmsg[0] = 0;
-    options->force_narrow_mode = 0;
-    options->valid = 1;
-    options->help_passed = 0;
-    return options;
+    (void)context;
+    return malloc(size);
 }
 
-static int _add_option_checked(struct cmdoptions* options, char short_identifier, const char* long_identifier, int numargs, const char* help);
-struct cmdoptions* cmdoptions_create(void)
+static void* _default_reallocate(void* context, void* ptr, size_t size)
 {
-    struct cmdoptions* options = cmdoptions_create_no_help();
-    _add_option_checked(options, 'h', "help", NO_ARG, "display help");
-    return options;
+    (void)context;
+    return realloc(ptr, size);
 }
 
-void cmdoptions_enable_narrow_mode(struct cmdoptions* options)
+static void _default_deallocate(void* context, void* ptr)
 {
-    options->force_narrow_mode = 1;
+    (void)context;
+    free(ptr);
 }
 
-void cmdoptions_disable_narrow_mode(struct cmdoptions* options)
+static const struct cmdoptions_allocator _default_allocator = {
+    _default_allocate,
+    _default_reallocate,
+    _default_deallocate,
+    NULL
+};
+
+/* used for caller-provided storage: the arena can never be extended */
+static void* _null_allocate(void* context, size_t size)
 {
-    options->force_narrow_mode = 0;
+    (void)context;
+    (void)size;
+    return NULL;
 }
 
-void _destroy_entry(void* ptr)
+static void* _null_reallocate(void* context, void* ptr, size_t size)
 {
-    struct entry* entry = ptr;
-    if(entry->what == OPTION)
-    {
-        struct option* option = entry->value;
-        if(option->argument)
-        {
-            if(option->numargs & MULTI_ARGS)
-            {
-                char** p = option->argument;
-                while(*p)
-                {
-                    free(*p);
-                    ++p;
-                }
-            }
-            free(option->argument);
-        }
-    }
-    else /* SECTION */
-    {
-        struct section* section = entry->value;
-        free(section->name);
-    }
-    free(entry->value);
-    free(ptr);
+    (void)context;
+    (void)ptr;
+    (void)size;
+    return NULL;
 }
 
-static void _destroy_mode(struct mode* mode)
+static void _null_deallocate(void* context, void* ptr)
 {
-    size_t i;
-    for(i = 0; i < mode->entries_size; ++i)
-    {
-        _destroy_entry(mode->entries[i]);
-    }
-    free(mode->entries);
-    free(mode->identifier);
-    free(mode);
+    (void)context;
+    (void)ptr;
 }
 
-void cmdoptions_destroy(struct cmdoptions* options)
+static const struct cmdoptions_allocator _null_allocator = {
+    _null_allocate,
+    _null_reallocate,
+    _null_deallocate,
+    NULL
+};
+
+#define ARENA_BLOCK_SIZE 16384
+
+union _max_align {
+    long l;
+    double d;
+    void* p;
+};
+
+static size_t _align(size_t size)
 {
-    size_t i;
-    char** p;
-    for(i = 0; i < options->size; ++i)
-    {
-        _destroy_mode(options->modes[i]);
-    }
-    free(options->modes);
-    p = options->positional_parameters;
-    while(*p)
-    {
-        free(*p);
-        ++p;
-    }
-    free(options->positional_parameters);
-    free(options->prehelpmsg);
-    free(options->posthelpmsg);
-    free(options);
+    return (size + sizeof(union _max_align) - 1) / sizeof(union _max_align) * sizeof(union _max_align);
 }
 
-void cmdoptions_exit(struct cmdoptions* options, int exitcode)
+static char* _arena_data(struct arena_block* block)
 {
-    cmdoptions_destroy(options);
-    exit(exitcode);
+    return (char*)block + _align(sizeof(*block));
 }
 
-int cmdoptions_is_valid(const struct cmdoptions* options)
+static struct arena_block* _arena_create_block(const struct cmdoptions_allocator* allocator, size_t size, struct arena_block* next)
 {
-    return options->valid;
+    struct arena_block* block;
+    if(size < ARENA_BLOCK_SIZE)
+    {
+        size = ARENA_BLOCK_SIZE;
+    }
+    block = allocator->allocate(allocator->context, _align(sizeof(*block)) + size);
+    if(!block)
+    {
+        return NULL;
+    }
+    block->next = next;
+    block->size = size;
+    block->used = 0;
+    block->last = 0;
+    return block;
 }
 
-int cmdoptions_assert_all_options_checked(const struct cmdoptions* options)
+static void _arena_destroy(const struct cmdoptions_allocator* allocator, struct arena_block* block)
 {
-    size_t i;
-    size_t j;
-    struct mode* mode;
-    struct entry* entry;
-    struct option* option;
-    for(i = 0; i < options->size; ++i)
+    struct arena_block* next;
+    while(block)
     {
-        mode = options->modes[i];
-        for(j = 0; j < mode->entries_size; ++j)
-        {
-            entry = mode->entries[j];
-            if(entry->what == OPTION)
-            {
-                option = entry->value;
-                if(!option->was_checked)
-                {
-                    if(option->long_identifier)
-                    {
-                        fprintf(stderr, "option '--%s' was no checked\n", option->long_identifier);
-                    }
-                    else
-                    {
-                        fprintf(stderr, "option '-%c' was no checked\n", option->short_identifier);
-                    }
-                    return 0;
-                }
-            }
-        }
+        next = block->next;
+        allocator->deallocate(allocator->context, block);
+        block = next;
     }
-    return 1;
 }
 
-static int _check_capacity(struct mode* mode)
+static void* _arena_alloc(const struct cmdoptions_allocator* allocator, struct arena_block** arena, size_t size)
 {
-    struct entry** tmp;
-    if(mode->entries_size + 1 > mode->entries_capacity)
+    struct arena_block* block = *arena;
+    size = _align(size);
+    if(block->size - block->used < size)
     {
-        mode->entries_capacity *= 2;
-        tmp = realloc(mode->entries, sizeof(*tmp) * mode->entries_capacity);
-        if(!tmp)
+        block = _arena_create_block(allocator, size, block);
+        if(!block)
         {
-            return 0;
+            return NULL;
         }
-        mode->entries = tmp;
+        *arena = block;
     }
-    return 1;
+    block->last = block->used;
+    block->used += size;
+    return _arena_data(block) + block->last;
 }
 
-static int _add_entry(struct mode* mode, struct entry* entry)
+static void* _arena_realloc(const struct cmdoptions_allocator* allocator, struct arena_block** arena, void* ptr, size_t oldsize, size_t newsize)
 {
-    if(!_check_capacity(mode))
+    struct arena_block* block = *arena;
+    void* new;
+    if(ptr && (char*)ptr == _arena_data(block) + block->last && block->last + _align(newsize) <= block->size)
     {
-        return 0;
+        block->used = block->last + _align(newsize);
+        return ptr;
     }
-    mode->entries[mode->entries_size] = entry;
-    mode->entries_size += 1;
-    return 1;
+    new = _arena_alloc(allocator, arena, newsize);
+    if(new && ptr)
+    {
+        memcpy(new, ptr, oldsize < newsize ? oldsize : newsize);
+    }
+    return new;
 }
 
-static struct mode* _find_mode(struct cmdoptions* options, const char* modename)
+static void _arena_free(struct arena_block* block, void* ptr)
 {
-    size_t i;
-    for(i = 1; i < options->size; ++i) /* start at 1: skip basemode */
+    /* only the most recent allocation can be given back */
+    if((char*)ptr == _arena_data(block) + block->last)
     {
-        if(strcmp(modename, options->modes[i]->identifier) == 0)
-        {
-            return options->modes[i];
-        }
+        block->used = block->last;
     }
-    return NULL;
 }
 
-static const struct mode* _find_const_mode(const struct cmdoptions* options, const char* modename)
+/* with instrumentation every allocation starts with its size, so that freeing it can be accounted for */
+#ifdef CMDOPTIONS_ENABLE_STATS
+#define _ALLOC_HEADER _align(sizeof(size_t))
+#define _ALLOC_BLOCK(ptr) ((char*)(ptr) - _ALLOC_HEADER)
+
+static void* _stats_allocated(struct cmdoptions* options, void* block, size_t oldsize, size_t newsize)
 {
-    size_t i;
-    for(i = 1; i < options->size; ++i) /* start at 1: skip basemode */
+    *(size_t*)block = newsize;
+    options->stats.allocations += 1;
+    options->stats.bytes_allocated += newsize;
+    options->stats.heap_size += newsize - oldsize;
+    if(options->stats.heap_size > options->stats.peak_heap_size)
     {
-        if(strcmp(modename, options->modes[i]->identifier) == 0)
-        {
-            return options->modes[i];
-        }
+        options->stats.peak_heap_size = options->stats.heap_size;
     }
-    return NULL;
+    return (char*)block + _ALLOC_HEADER;
 }
 
-int cmdoptions_mode_add_section(struct cmdoptions* options, const char* modename, const char* name)
+#define _STATS_ALLOCATED(options, block, oldsize, newsize) _stats_allocated(options, block, oldsize, newsize)
+#define _STATS_FREED(options, ptr) (options->stats.heap_size -= *(size_t*)_ALLOC_BLOCK(ptr))
+#else
+#define _ALLOC_HEADER 0
+#define _ALLOC_BLOCK(ptr) (ptr)
+#define _STATS_ALLOCATED(options, block, oldsize, newsize) (block)
+#define _STATS_FREED(options, ptr) ((void)0)
+#endif
+
+/* a failed allocation invalidates the structure, this is how running out of caller-provided storage is reported */
+static void* _alloc(struct cmdoptions* options, size_t size)
 {
-    struct entry* entry;
-    struct section* section = malloc(sizeof(*section));
-    struct mode* mode = _find_mode(options, modename);
-    if(!mode)
+    void* ptr;
+    if(options->arena)
     {
-        return 0;
+        ptr = _arena_alloc(&options->allocator, &options->arena, _ALLOC_HEADER + size);
     }
-    section->name = malloc(strlen(name) + 1);
-    if(!section->name)
+    else
     {
-        free(section);
-        return 0;
+        ptr = options->allocator.allocate(options->allocator.context, _ALLOC_HEADER + size);
     }
-    strcpy(section->name, name);
-    entry = malloc(sizeof(*entry));
-    entry->what = SECTION;
-    entry->value = section;
-    if(!_add_entry(mode, entry))
+    if(!ptr)
     {
-        free(section);
-        free(entry);
-        return 0;
+        options->valid = 0;
+        return NULL;
     }
-    return 1;
+    return _STATS_ALLOCATED(options, ptr, 0, size);
 }
 
-int cmdoptions_add_section(struct cmdoptions* options, const char* name)
+static void* _realloc(struct cmdoptions* options, void* ptr, size_t oldsize, size_t newsize)
 {
-    struct mode* mode = options->modes[0]; /* base mode */
-    struct entry* entry;
-    struct section* section = malloc(sizeof(*section));
-    section->name = malloc(strlen(name) + 1);
-    if(!section->name)
+    void* new;
+    void* block = ptr ? _ALLOC_BLOCK(ptr) : NULL;
+    if(options->arena)
     {
-        free(section);
-        return 0;
+        new = _arena_realloc(&options->allocator, &options->arena, block, _ALLOC_HEADER + oldsize, _ALLOC_HEADER + newsize);
     }
-    strcpy(section->name, name);
-    entry = malloc(sizeof(*entry));
-    entry->what = SECTION;
-    entry->value = section;
-    if(!_add_entry(mode, entry))
+    else
     {
-        free(section);
-        free(entry);
-        return 0;
+        new = options->allocator.reallocate(options->allocator.context, block, _ALLOC_HEADER + newsize);
     }
-    return 1;
+    if(!new)
+    {
+        options->valid = 0;
+        return NULL;
+    }
+    return _STATS_ALLOCATED(options, new, ptr ? oldsize : 0, newsize);
 }
 
-static struct entry* _create_option(char short_identifier, const char* long_identifier, int numargs, const char* help)
+static void _free(struct cmdoptions* options, void* ptr)
 {
-    struct entry* entry;
-    struct option* option = malloc(sizeof(*option));
-    if(!option)
+    if(!ptr)
     {
-        return NULL;
+        return;
     }
-    option->short_identifier = short_identifier;
-    option->long_identifier = long_identifier;
-    option->numargs = numargs;
-    option->argument = NULL;
-    option->was_provided = 0;
-    option->was_checked = 0;
-    option->help = help;
-    option->aliased = NULL;
-    entry = malloc(sizeof(*entry));
-    if(!entry)
+    _STATS_FREED(options, ptr);
+    if(options->arena)
     {
-        free(option);
-        return NULL;
+        _arena_free(options->arena, _ALLOC_BLOCK(ptr));
+    }
+    else
+    {
+        options->allocator.deallocate(options->allocator.context, _ALLOC_BLOCK(ptr));
     }
-    entry->value = option;
-    entry->what = OPTION;
-    return entry;
-}
-
-static struct mode* _get_basemode(struct cmdoptions* options)
-{
-    return options->modes[0];
-}
-
-static const struct mode* _get_const_basemode(const struct cmdoptions* options)
-{
-    return options->modes[0];
 }
 
-int cmdoptions_add_mode(struct cmdoptions* options, const char* modename)
+static char* _copy_string(struct cmdoptions* options, const char* str)
 {
-    struct mode* mode;
-    if(_find_const_mode(options, modename))
+    char* copy = _alloc(options, strlen(str) + 1);
+    if(copy)
     {
-        return 0;
+        strcpy(copy, str);
     }
-    options->size += 1;
-    options->capacity += 1; /* capacity really needed? */
-    options->modes = realloc(options->modes, options->capacity * sizeof(*options->modes));
-    mode = malloc(sizeof(*mode));
-    mode->identifier = malloc(strlen(modename) + 1);
-    strcpy(mode->identifier, modename);
-    mode->entries_size = 0;
-    mode->entries_capacity = 1;
-    mode->entries = malloc(mode->entries_capacity * sizeof(*mode->entries));
-    mode->was_selected = 0;
-    options->modes[options->size - 1] = mode;
-    return 1;
+    return copy;
 }
 
-int cmdoptions_add_alias(struct cmdoptions* options, const char* long_aliased_identifier, char short_identifier, const char* long_identifier, const char* help)
+/* the built-in result allocates like its structure (arena, caller-provided storage), other results use the allocator directly */
+static void* _result_alloc(struct cmdoptions_result* result, size_t size)
 {
-    struct entry* entry;
-    struct option* alias = NULL;
-    unsigned int i;
-    struct mode* basemode = _get_basemode(options);
-    for(i = 0; i < basemode->entries_size; ++i)
+    void* ptr;
+    if(result->owner)
     {
-        struct entry* entry = basemode->entries[i];
-        if(entry->what == OPTION)
-        {
-            struct option* option = entry->value;
-            if(strcmp(option->long_identifier, long_aliased_identifier) == 0)
-            {
-                alias = option;
-                break;
-            }
-        }
+        ptr = _alloc(result->owner, size);
     }
-
-    entry = _create_option(short_identifier, long_identifier, 0, help); /* num_args will never be used */
-    if(!entry)
+    else
     {
-        return 0;
+        ptr = result->allocator.allocate(result->allocator.context, size);
     }
-    ((struct option*)entry->value)->aliased = alias;
-    if(!_add_entry(basemode, entry))
+    if(!ptr)
     {
-        _destroy_entry(entry);
-        return 0;
+        result->valid = 0;
     }
-    return 1;
+    return ptr;
 }
 
-static int _add_option_checked(struct cmdoptions* options, char short_identifier, const char* long_identifier, int numargs, const char* help)
+static void* _result_realloc(struct cmdoptions_result* result, void* ptr, size_t oldsize, size_t newsize)
 {
-    struct entry* entry = _create_option(short_identifier, long_identifier, numargs, help);
-    struct option* option = entry->value;
-    option->was_checked = 1;
-    if(!entry)
+    void* new;
+    if(result->owner)
     {
-        return 0;
+        new = _realloc(result->owner, ptr, oldsize, newsize);
     }
-    struct mode* basemode = _get_basemode(options);
-    if(!_add_entry(basemode, entry))
+    else
     {
-        _destroy_entry(entry);
-        return 0;
+        new = result->allocator.reallocate(result->allocator.context, ptr, newsize);
     }
-    return 1;
+    if(!new)
+    {
+        result->valid = 0;
+    }
+    return new;
 }
 
-int cmdoptions_add_option(struct cmdoptions* options, char short_identifier, const char* long_identifier, int numargs, const char* help)
+static void _result_free(struct cmdoptions_result* result, void* ptr)
 {
-    struct entry* entry = _create_option(short_identifier, long_identifier, numargs, help);
-    if(!entry)
+    if(result->owner)
     {
-        return 0;
+        _free(result->owner, ptr);
     }
-    struct mode* basemode = _get_basemode(options);
-    if(!_add_entry(basemode, entry))
+    else if(ptr)
     {
-        _destroy_entry(entry);
-        return 0;
+        result->allocator.deallocate(result->allocator.context, ptr);
     }
-    return 1;
 }
 
-int cmdoptions_mode_add_option(struct cmdoptions* options, const char* modename, char short_identifier, const char* long_identifier, int numargs, const char* help)
+static char* _result_copy_string(struct cmdoptions_result* result, const char* str)
 {
-    struct entry* entry = _create_option(short_identifier, long_identifier, numargs, help);
-    if(!entry)
+    char* copy = _result_alloc(result, strlen(str) + 1);
+    if(copy)
     {
-        return 0;
+        strcpy(copy, str);
     }
-    struct mode* mode = _find_mode(options, modename);
-    if(!_add_entry(mode, entry))
+    return copy;
+}
+
+static int _init_result(struct cmdoptions_result* result, const struct cmdoptions* options, struct cmdoptions* owner)
+{
+    result->options = options;
+    result->owner = owner;
+    result->allocator = options->allocator;
+    result->states = NULL;
+    result->states_capacity = 0;
+    result->modes = NULL;
+    result->modes_capacity = 0;
+    result->provided = NULL;
+    result->selected = NULL;
+    result->positional_parameters_size = 0;
+    result->positional_parameters_capacity = 1;
+    result->positional_parameters_borrowed = 0;
+    result->response_files = NULL;
+    result->help_passed = 0;
+    result->valid = 1;
+#ifdef CMDOPTIONS_ENABLE_STATS
+    memset(&result->stats, 0, sizeof(result->stats));
+#endif
+    result->positional_parameters = _result_alloc(result, sizeof(*result->positional_parameters));
+    if(!result->positional_parameters)
     {
-        _destroy_entry(entry);
         return 0;
     }
+    *result->positional_parameters = NULL; /* sentinel */
     return 1;
 }
 
-int cmdoptions_add_option_default(struct cmdoptions* options, char short_identifier, const char* long_identifier, int numargs, const char* default_arg, const char* help)
+/* makes room for the states of noptions options and nmodes modes, the new states are empty */
+static int _reserve_result(struct cmdoptions_result* result, size_t noptions, size_t nmodes)
 {
-    struct entry* entry = _create_option(short_identifier, long_identifier, numargs, help);
-    if(!entry)
-    {
-        return 0;
-    }
-    struct mode* basemode = _get_basemode(options);
-    if(numargs > 1)
+    size_t i;
+    size_t capacity;
+    struct option_state* states;
+    struct mode_state* modes;
+    if(noptions > result->states_capacity)
     {
-        char** arg = calloc(2, sizeof(*arg));
-        arg[0] = malloc(strlen(default_arg) + 1);
-        strcpy(arg[0], default_arg);
-        arg[1] = NULL;
-        ((struct option*)entry->value)->argument = arg;
-    }
-    else
+        capacity = 2 * result->states_capacity;
+        if(capacity < noptions)
+        {
+            capacity = noptions;
+        }
+        states = _result_realloc(result, result->states, result->states_capacity * sizeof(*states), capacity * sizeof(*states));
+        if(!states)
+        {
+            return 0;
+        }
+        for(i = result->states_capacity; i < capacity; ++i)
+        {
+            states[i].argument = NULL;
+            states[i].argument_size = 0;
+            states[i].argument_capacity = 0;
+            states[i].argument_borrowed = 0;
+            states[i].was_provided = 0;
+            states[i].was_checked = 0;
+            states[i].next_provided = NULL;
+        }
+        result->states = states;
+        result->states_capacity = capacity;
+    }
+    if(nmodes > result->modes_capacity)
+    {
+        capacity = 2 * result->modes_capacity;
+        if(capacity < nmodes)
+        {
+            capacity = nmodes;
+        }
+        modes = _result_realloc(result, result->modes, result->modes_capacity * sizeof(*modes), capacity * sizeof(*modes));
+        if(!modes)
+        {
+            return 0;
+        }
+        for(i = result->modes_capacity; i < capacity; ++i)
+        {
+            modes[i].was_selected = i == 0; /* basemode is always selected */
+            modes[i].next_selected = NULL;
+        }
+        result->modes = modes;
+        result->modes_capacity = capacity;
+    }
+    return 1;
+}
+
+static struct option_state* _state(const struct cmdoptions_result* result, const struct option* option)
+{
+    return &result->states[option->id];
+}
+
+static struct mode* _create_mode(struct cmdoptions* options, char* identifier)
+{
+    unsigned int i;
+    struct mode* mode = _alloc(options, sizeof(*mode));
+    if(!mode)
+    {
+        return NULL;
+    }
+    mode->identifier = identifier;
+    mode->identifier_static = 0;
+    mode->entries_size = 0;
+    mode->entries_capacity = 1;
+    mode->entries = _alloc(options, mode->entries_capacity * sizeof(*mode->entries));
+    if(!mode->entries)
+    {
+        _free(options, mode);
+        return NULL;
+    }
+    for(i = 0; i < 256; ++i)
+    {
+        mode->short_index[i] = NULL;
+    }
+    mode->long_index.slots = NULL;
+    mode->long_index.size = 0;
+    mode->long_index.capacity = 0;
+    mode->table = NULL;
+    mode->static_entries = NULL;
+    mode->id = options->size; /* the mode is appended to the modes */
+    return mode;
+}
+
+static struct cmdoptions* _create_no_help(const struct cmdoptions_allocator* allocator, struct arena_block* arena)
+{
+    struct cmdoptions* options;
+    struct mode* basemode;
+    if(arena)
+    {
+        /* the structure itself is the first allocation in the arena */
+        options = _arena_alloc(allocator, &arena, sizeof(*options));
+        if(!options)
+        {
+            _arena_destroy(allocator, arena);
+            return NULL;
+        }
+    }
+    else
+    {
+        options = allocator->allocate(allocator->context, sizeof(*options));
+        if(!options)
+        {
+            return NULL;
+        }
+    }
+    options->allocator = *allocator;
+    options->arena = arena;
+    options->valid = 1;
+#ifdef CMDOPTIONS_ENABLE_STATS
+    memset(&options->stats, 0, sizeof(options->stats));
+#endif
+    options->size = 0;
+    options->noptions = 0;
+    options->frozen = 0;
+    options->capacity = 8;
+    options->modes = _alloc(options, options->capacity * sizeof(*options->modes));
+    basemode = _create_mode(options, NULL);
+    options->result = _alloc(options, sizeof(*options->result));
+    if(options->result && _init_result(options->result, options, options))
+    {
+        _reserve_result(options->result, 0, 1);
+    }
+    options->prehelpmsg = _alloc(options, 1);
+    options->posthelpmsg = _alloc(options, 1);
+    if(!options->valid) /* any of the allocations above failed */
+    {
+        if(arena)
+        {
+            _arena_destroy(allocator, options->arena);
+        }
+        else
+        {
+            _free(options, options->modes);
+            if(basemode)
+            {
+                _free(options, basemode->entries);
+                _free(options, basemode);
+            }
+            if(options->result)
+            {
+                _free(options, options->result->positional_parameters);
+                _free(options, options->result->modes);
+                _free(options, options->result);
+            }
+            _free(options, options->prehelpmsg);
+            _free(options, options->posthelpmsg);
+            allocator->deallocate(allocator->context, options);
+        }
+        return NULL;
+    }
+    options->modes[0] = basemode;
+    options->size = 1;
+    options->mode_index.slots = NULL;
+    options->mode_index.size = 0;
+    options->mode_index.capacity = 0;
+    options->prehelpmsg[0] = 0;
+    options->posthelpmsg[0] = 0;
+    options->force_narrow_mode = 0;
+    options->optwidth = 0;
+    options->borrow_arguments = 0;
+    options->static_strings = 0;
+    options->marked = 0;
+    options->expand_response_files = 0;
+    options->table = NULL;
+    options->static_entries = NULL;
+    options->snapshot_table = NULL;
+    options->snapshot = NULL;
+    options->snapshot_size = 0;
+    options->snapshot_mapped = 0;
+    options->static_help = NULL;
+    options->static_help_size = 0;
+    options->static_manpage = NULL;
+    return options;
+}
+
+struct cmdoptions* cmdoptions_create_no_help(void)
+{
+    return _create_no_help(&_default_allocator, NULL);
+}
+
+static int _add_option_checked(struct cmdoptions* options, char short_identifier, const char* long_identifier, int numargs, const char* help);
+struct cmdoptions* cmdoptions_create(void)
+{
+    struct cmdoptions* options = _create_no_help(&_default_allocator, NULL);
+    if(options)
+    {
+        _add_option_checked(options, 'h', "help", NO_ARG, "display help");
+    }
+    return options;
+}
+
+struct cmdoptions* cmdoptions_create_with_arena(void)
+{
+    struct cmdoptions* options;
+    struct arena_block* arena = _arena_create_block(&_default_allocator, 0, NULL);
+    if(!arena)
+    {
+        return NULL;
+    }
+    options = _create_no_help(&_default_allocator, arena);
+    if(options)
+    {
+        _add_option_checked(options, 'h', "help", NO_ARG, "display help");
+    }
+    return options;
+}
+
+struct cmdoptions* cmdoptions_create_with_allocator(const struct cmdoptions_allocator* allocator)
+{
+    struct cmdoptions* options = _create_no_help(allocator, NULL);
+    if(options)
+    {
+        _add_option_checked(options, 'h', "help", NO_ARG, "display help");
+    }
+    return options;
+}
+
+struct cmdoptions* cmdoptions_create_with_storage(void* storage, size_t size)
+{
+    struct cmdoptions* options;
+    struct arena_block* block;
+    size_t offset = _align((size_t)storage) - (size_t)storage;
+    if(size < offset + _align(sizeof(*block)))
+    {
+        return NULL;
+    }
+    /* the storage is the one and only arena block */
+    block = (struct arena_block*)((char*)storage + offset);
+    block->next = NULL;
+    block->size = size - offset - _align(sizeof(*block));
+    block->used = 0;
+    block->last = 0;
+    options = _create_no_help(&_null_allocator, block);
+    if(options)
+    {
+        if(!_add_option_checked(options, 'h', "help", NO_ARG, "display help"))
+        {
+            return NULL;
+        }
+    }
+    return options;
+}
+
+/*
+ * pre-rendered output no longer matches once anything is added to the definition,
+ * and the arena can no longer be rewound to the state recorded by the last parse
+ */
+static void _definition_changed(struct cmdoptions* options)
+{
+    options->static_help = NULL;
+    options->static_help_size = 0;
+    options->static_manpage = NULL;
+    options->marked = 0;
+}
+
+/* results share the definition, so it must not change after cmdoptions_freeze */
+static int _frozen(const struct cmdoptions* options)
+{
+    if(options->frozen)
+    {
+        fprintf(stderr, "trying to change a frozen command-line definition\n");
+        return 1;
+    }
+    return 0;
+}
+
+static void _append_to_message(struct cmdoptions* options, char** message, const char* msg);
+static void _update_optwidth(struct cmdoptions* options, const struct option* option);
+static int _convert_argument(int numargs, const char* arg, union typed_value* value);
+static void _create_static_entry(struct cmdoptions* options, struct entry* entry, const struct cmdoptions_static_entry* definition, struct option** option, struct section** section)
+{
+    char** args;
+    if(definition->what == CMDOPTIONS_STATIC_OPTION)
+    {
+        (*option)->short_identifier = definition->short_identifier;
+        (*option)->long_identifier = definition->long_identifier;
+        (*option)->long_length = definition->long_identifier ? strlen(definition->long_identifier) : 0;
+        (*option)->numargs = definition->numargs;
+        (*option)->default_argument = (char*)definition->default_argument;
+        (*option)->default_static = 1;
+        (*option)->checked = definition->checked;
+        (*option)->help = definition->help;
+        (*option)->aliased = NULL;
+        (*option)->id = options->noptions;
+        options->noptions += 1;
+        if((definition->numargs & ARG_TYPE_MASK) > DURATION_ARG)
+        {
+            fprintf(stderr, "unknown argument type of command-line option '%s'\n", definition->long_identifier ? definition->long_identifier : "");
+            options->valid = 0;
+        }
+        else if(definition->default_argument && (definition->numargs & ARG_TYPE_MASK) && !_convert_argument(definition->numargs, definition->default_argument, &(*option)->default_value))
+        {
+            options->valid = 0;
+        }
+        if(definition->default_argument && (definition->numargs & MULTI_ARGS))
+        {
+            args = _alloc(options, 2 * sizeof(*args));
+            if(args)
+            {
+                args[0] = (char*)definition->default_argument;
+                args[1] = NULL;
+            }
+            (*option)->default_argument = args;
+        }
+        entry->what = OPTION;
+        entry->value = *option;
+        *option += 1;
+    }
+    else
+    {
+        (*section)->name = (char*)definition->long_identifier;
+        (*section)->name_static = 1;
+        entry->what = SECTION;
+        entry->value = *section;
+        *section += 1;
+    }
+}
+
+/*
+ * all structures are created in one go on an arena, the strings are taken from the table
+ * the lookup indices are not built, the perfect hashes and short tables of the table are used instead
+ */
+struct cmdoptions* cmdoptions_create_static(const struct cmdoptions_static_table* table)
+{
+    struct cmdoptions* options;
+    struct arena_block* arena;
+    struct mode** modes;
+    struct mode* mode;
+    struct option* option;
+    struct section* section;
+    const struct cmdoptions_static_mode* definition;
+    size_t noptions = 0;
+    size_t m;
+    size_t i;
+    for(m = 0; m < table->size; ++m)
+    {
+        for(i = 0; i < table->modes[m].size; ++i)
+        {
+            noptions += table->modes[m].entries[i].what == CMDOPTIONS_STATIC_OPTION;
+        }
+    }
+    arena = _arena_create_block(&_default_allocator,
+        sizeof(*options) + table->size * (sizeof(*mode) + sizeof(mode) + sizeof(struct mode_state)) +
+        table->entries * (sizeof(struct entry) + sizeof(struct entry*) + sizeof(*section)) + noptions * (sizeof(*option) + sizeof(struct option_state)) + 1024,
+        NULL);
+    if(!arena)
+    {
+        return NULL;
+    }
+    options = _create_no_help(&_default_allocator, arena);
+    if(!options)
+    {
+        return NULL;
+    }
+    options->table = table;
+    if(table->size > options->capacity)
+    {
+        modes = _realloc(options, options->modes, options->capacity * sizeof(*modes), table->size * sizeof(*modes));
+        if(modes)
+        {
+            options->modes = modes;
+            options->capacity = table->size;
+        }
+    }
+    options->static_entries = _alloc(options, (table->entries ? table->entries : 1) * sizeof(*options->static_entries));
+    option = _alloc(options, (noptions ? noptions : 1) * sizeof(*option));
+    section = _alloc(options, (table->entries - noptions ? table->entries - noptions : 1) * sizeof(*section));
+    _reserve_result(options->result, noptions, table->size);
+    if(!options->valid)
+    {
+        cmdoptions_destroy(options);
+        return NULL;
+    }
+    for(m = 0; m < table->size; ++m)
+    {
+        definition = &table->modes[m];
+        if(m == 0)
+        {
+            mode = options->modes[0]; /* base mode */
+        }
+        else
+        {
+            mode = _create_mode(options, (char*)definition->identifier);
+            if(!mode)
+            {
+                cmdoptions_destroy(options);
+                return NULL;
+            }
+            mode->identifier_static = 1;
+            options->modes[m] = mode;
+            options->size = m + 1;
+        }
+        mode->table = definition;
+        mode->static_entries = options->static_entries + definition->first_entry;
+        if(definition->size > mode->entries_capacity)
+        {
+            _free(options, mode->entries);
+            mode->entries = _alloc(options, definition->size * sizeof(*mode->entries));
+            mode->entries_capacity = definition->size;
+            if(!mode->entries)
+            {
+                cmdoptions_destroy(options);
+                return NULL;
+            }
+        }
+        for(i = 0; i < definition->size; ++i)
+        {
+            _create_static_entry(options, &mode->static_entries[i], &definition->entries[i], &option, &section);
+            mode->entries[i] = &mode->static_entries[i];
+            if(mode->entries[i]->what == OPTION)
+            {
+                _update_optwidth(options, mode->entries[i]->value);
+            }
+        }
+        mode->entries_size = definition->size;
+        /* aliases can only be resolved once all entries of the mode exist */
+        for(i = 0; i < definition->size; ++i)
+        {
+            if(definition->entries[i].what == CMDOPTIONS_STATIC_OPTION && definition->entries[i].aliased >= 0)
+            {
+                ((struct option*)mode->static_entries[i].value)->aliased = mode->static_entries[definition->entries[i].aliased].value;
+            }
+        }
+    }
+    if(table->prehelpmsg[0])
+    {
+        _append_to_message(options, &options->prehelpmsg, table->prehelpmsg);
+    }
+    if(table->posthelpmsg[0])
+    {
+        _append_to_message(options, &options->posthelpmsg, table->posthelpmsg);
+    }
+    /* only now, appending the messages drops them */
+    options->static_help = table->help;
+    options->static_help_size = table->help_size;
+    options->static_manpage = table->manpage;
+    if(!options->valid)
+    {
+        cmdoptions_destroy(options);
+        return NULL;
+    }
+    return options;
+}
+
+size_t cmdoptions_get_storage_used(const struct cmdoptions* options)
+{
+    size_t used = 0;
+    const struct arena_block* block = options->arena;
+    while(block)
+    {
+        used += _align(sizeof(*block)) + block->used;
+        block = block->next;
+    }
+    return used;
+}
+
+void cmdoptions_enable_narrow_mode(struct cmdoptions* options)
+{
+    options->force_narrow_mode = 1;
+}
+
+void cmdoptions_disable_narrow_mode(struct cmdoptions* options)
+{
+    options->force_narrow_mode = 0;
+}
+
+void cmdoptions_enable_borrowed_arguments(struct cmdoptions* options)
+{
+    options->borrow_arguments = 1;
+}
+
+void cmdoptions_disable_borrowed_arguments(struct cmdoptions* options)
+{
+    options->borrow_arguments = 0;
+}
+
+void cmdoptions_enable_response_files(struct cmdoptions* options)
+{
+    options->expand_response_files = 1;
+}
+
+void cmdoptions_disable_response_files(struct cmdoptions* options)
+{
+    options->expand_response_files = 0;
+}
+
+void cmdoptions_enable_static_strings(struct cmdoptions* options)
+{
+    options->static_strings = 1;
+}
+
+void cmdoptions_disable_static_strings(struct cmdoptions* options)
+{
+    options->static_strings = 0;
+}
+
+/* copies definition strings, unless they are known to outlive the structure */
+static char* _definition_string(struct cmdoptions* options, const char* str)
+{
+    if(options->static_strings)
+    {
+        return (char*)str;
+    }
+    return _copy_string(options, str);
+}
+
+/* typed arguments: conversion of the argument strings */
+static const char* _type_error(int numargs)
+{
+    static const char* messages[] = { "invalid argument", "invalid integer argument", "invalid non-negative integer argument", "invalid number argument",
+        "invalid boolean argument", "invalid size argument", "invalid duration argument" };
+    size_t type = (numargs & ARG_TYPE_MASK) >> 4;
+    return type < sizeof(messages) / sizeof(*messages) ? messages[type] : messages[0];
+}
+
+static size_t _typed_size(int numargs)
+{
+    switch(numargs & ARG_TYPE_MASK)
+    {
+        case INT_ARG:
+            return sizeof(long);
+        case UINT_ARG:
+            return sizeof(unsigned long);
+        case BOOL_ARG:
+            return sizeof(int);
+        case SIZE_ARG:
+            return sizeof(size_t);
+        default: /* DOUBLE_ARG, DURATION_ARG */
+            return sizeof(double);
+    }
+}
+
+/* copy a value into an array element of the type */
+static void _put_typed(void* dest, int numargs, const union typed_value* value)
+{
+    switch(numargs & ARG_TYPE_MASK)
+    {
+        case INT_ARG:
+            *(long*)dest = value->int_value;
+            break;
+        case UINT_ARG:
+            *(unsigned long*)dest = value->uint_value;
+            break;
+        case BOOL_ARG:
+            *(int*)dest = value->bool_value;
+            break;
+        case SIZE_ARG:
+            *(size_t*)dest = value->size_value;
+            break;
+        default:
+            *(double*)dest = value->double_value;
+            break;
+    }
+}
+
+static int _equal_nocase(const char* lhs, const char* rhs)
+{
+    while(*lhs && tolower((unsigned char)*lhs) == tolower((unsigned char)*rhs))
+    {
+        ++lhs;
+        ++rhs;
+    }
+    return *lhs == *rhs;
+}
+
+/* strtoul and strtod accept leading whitespace and signs, which are not wanted for most types */
+static int _starts_with_digit(const char* arg)
+{
+    return isdigit((unsigned char)arg[0]) || (arg[0] == '.' && isdigit((unsigned char)arg[1]));
+}
+
+static int _convert_size(const char* arg, size_t* size)
+{
+    static const char* suffixes = "KMGT";
+    const char* suffix;
+    char* end;
+    unsigned long value;
+    size_t factor = 1;
+    if(!isdigit((unsigned char)arg[0]))
+    {
+        return 0;
+    }
+    errno = 0;
+    value = strtoul(arg, &end, 10);
+    if(errno == ERANGE)
+    {
+        return 0;
+    }
+    if(*end && (suffix = strchr(suffixes, toupper((unsigned char)*end))) != NULL)
+    {
+        size_t i;
+        for(i = 0; i <= (size_t)(suffix - suffixes); ++i)
+        {
+            if(factor > (size_t)-1 / 1024)
+            {
+                return 0;
+            }
+            factor *= 1024;
+        }
+        ++end;
+        if(*end == 'i' && toupper((unsigned char)end[1]) == 'B') /* KiB */
+        {
+            ++end;
+        }
+    }
+    if(toupper((unsigned char)*end) == 'B')
+    {
+        ++end;
+    }
+    if(*end || value > (size_t)-1 / factor)
+    {
+        return 0;
+    }
+    *size = (size_t)value * factor;
+    return 1;
+}
+
+static int _convert_duration(const char* arg, double* seconds)
+{
+    static const char* units[] = { "ns", "us", "ms", "s", "m", "h", "d" };
+    static const double factors[] = { 1e-9, 1e-6, 1e-3, 1.0, 60.0, 3600.0, 86400.0 };
+    const char* cursor = arg;
+    char* end;
+    double value;
+    size_t i;
+    size_t length;
+    *seconds = 0.0;
+    do
+    {
+        if(!_starts_with_digit(cursor))
+        {
+            return 0;
+        }
+        errno = 0;
+        value = strtod(cursor, &end);
+        if(errno == ERANGE)
+        {
+            return 0;
+        }
+        if(!*end && cursor == arg) /* plain number */
+        {
+            *seconds = value;
+            return 1;
+        }
+        for(i = 0; i < sizeof(units) / sizeof(*units); ++i)
+        {
+            length = strlen(units[i]);
+            if(strncmp(end, units[i], length) == 0)
+            {
+                break;
+            }
+        }
+        if(i == sizeof(units) / sizeof(*units))
+        {
+            return 0;
+        }
+        *seconds += value * factors[i];
+        cursor = end + length;
+    }
+    while(*cursor);
+    return 1;
+}
+
+/* the member of the type, that is an array of one value (the default of a multiple option) */
+static const void* _typed_element(int numargs, const union typed_value* value)
+{
+    switch(numargs & ARG_TYPE_MASK)
+    {
+        case INT_ARG:
+            return &value->int_value;
+        case UINT_ARG:
+            return &value->uint_value;
+        case BOOL_ARG:
+            return &value->bool_value;
+        case SIZE_ARG:
+            return &value->size_value;
+        default:
+            return &value->double_value;
+    }
+}
+
+/* returns 0 if arg is not a valid value of the type */
+static int _convert_argument(int numargs, const char* arg, union typed_value* value)
+{
+    char* end;
+    errno = 0;
+    switch(numargs & ARG_TYPE_MASK)
+    {
+        case INT_ARG:
+            if(!_starts_with_digit(arg) && !(arg[0] == '-' && isdigit((unsigned char)arg[1])))
+            {
+                return 0;
+            }
+            value->int_value = strtol(arg, &end, 10);
+            return !*end && errno != ERANGE;
+        case UINT_ARG:
+            if(!isdigit((unsigned char)arg[0]))
+            {
+                return 0;
+            }
+            value->uint_value = strtoul(arg, &end, 10);
+            return !*end && errno != ERANGE;
+        case DOUBLE_ARG:
+            if(!_starts_with_digit(arg) && !((arg[0] == '-' || arg[0] == '+') && _starts_with_digit(arg + 1)))
+            {
+                return 0;
+            }
+            value->double_value = strtod(arg, &end);
+            return !*end && errno != ERANGE;
+        case BOOL_ARG:
+            if(_equal_nocase(arg, "true") || _equal_nocase(arg, "yes") || _equal_nocase(arg, "on") || strcmp(arg, "1") == 0)
+            {
+                value->bool_value = 1;
+                return 1;
+            }
+            value->bool_value = 0;
+            return _equal_nocase(arg, "false") || _equal_nocase(arg, "no") || _equal_nocase(arg, "off") || strcmp(arg, "0") == 0;
+        case SIZE_ARG:
+            return _convert_size(arg, &value->size_value);
+        case DURATION_ARG:
+            return _convert_duration(arg, &value->double_value);
+        default:
+            return 0;
+    }
+}
+
+static void _free_argument(struct cmdoptions_result* result, const struct option* option)
+{
+    size_t i;
+    struct option_state* state = _state(result, option);
+    if(!state->argument)
+    {
+        return;
+    }
+    if(!state->argument_borrowed && !(option->numargs & ARG_TYPE_MASK))
+    {
+        if(option->numargs & MULTI_ARGS)
+        {
+            for(i = 0; i < state->argument_size; ++i)
+            {
+                _result_free(result, ((char**)state->argument)[i]);
+            }
+        }
+        else
+        {
+            _result_free(result, state->argument);
+        }
+    }
+    if(option->numargs & MULTI_ARGS)
+    {
+        _result_free(result, state->argument);
+    }
+    state->argument = NULL;
+    state->argument_size = 0;
+    state->argument_capacity = 0;
+}
+
+/* like _free_argument, but the array of a multiple option is kept for the next command line */
+static void _clear_argument(struct cmdoptions_result* result, const struct option* option)
+{
+    size_t i;
+    struct option_state* state = _state(result, option);
+    if(!(option->numargs & MULTI_ARGS) || !state->argument)
+    {
+        _free_argument(result, option);
+        return;
+    }
+    if(option->numargs & ARG_TYPE_MASK) /* values, no strings and no sentinel */
+    {
+        state->argument_size = 0;
+        return;
+    }
+    if(!state->argument_borrowed)
+    {
+        for(i = 0; i < state->argument_size; ++i)
+        {
+            _result_free(result, ((char**)state->argument)[i]);
+        }
+    }
+    state->argument_size = 0;
+    ((char**)state->argument)[0] = NULL;
+}
+
+static void _release_response_file(struct cmdoptions_result* result, struct response_file* file);
+static void _release_response_files(struct cmdoptions_result* result)
+{
+    struct response_file* file;
+    while(result->response_files)
+    {
+        file = result->response_files;
+        result->response_files = file->next;
+        _release_response_file(result, file);
+    }
+}
+
+/* frees everything the result allocated, except the result itself (the definition has to be intact) */
+static void _destroy_result(struct cmdoptions_result* result)
+{
+    size_t i;
+    size_t j;
+    const struct mode* mode;
+    _release_response_files(result);
+    for(i = 0; i < result->options->size; ++i)
+    {
+        mode = result->options->modes[i];
+        for(j = 0; j < mode->entries_size; ++j)
+        {
+            if(mode->entries[j]->what == OPTION)
+            {
+                _free_argument(result, mode->entries[j]->value);
+            }
+        }
+    }
+    if(!result->positional_parameters_borrowed)
+    {
+        for(i = 0; i < result->positional_parameters_size; ++i)
+        {
+            _result_free(result, result->positional_parameters[i]);
+        }
+    }
+    _result_free(result, result->positional_parameters);
+    _result_free(result, result->states);
+    _result_free(result, result->modes);
+}
+
+static void _destroy_entry(struct cmdoptions* options, struct entry* entry)
+{
+    if(entry->what == OPTION)
+    {
+        struct option* option = entry->value;
+        if(option->default_argument)
+        {
+            if(option->numargs & MULTI_ARGS)
+            {
+                if(!option->default_static)
+                {
+                    _free(options, *(char**)option->default_argument);
+                }
+                _free(options, option->default_argument);
+            }
+            else if(!option->default_static)
+            {
+                _free(options, option->default_argument);
+            }
+        }
+    }
+    else /* SECTION */
+    {
+        struct section* section = entry->value;
+        if(!section->name_static)
+        {
+            _free(options, section->name);
+        }
+    }
+    _free(options, entry->value);
+    _free(options, entry);
+}
+
+static void _destroy_mode(struct cmdoptions* options, struct mode* mode)
+{
+    size_t i;
+    for(i = 0; i < mode->entries_size; ++i)
+    {
+        _destroy_entry(options, mode->entries[i]);
+    }
+    _free(options, mode->entries);
+    _free(options, mode->long_index.slots);
+    if(!mode->identifier_static)
+    {
+        _free(options, mode->identifier);
+    }
+    _free(options, mode);
+}
+
+static void _release_snapshot(char* snapshot, size_t size, int mapped, struct cmdoptions_static_table* table);
+/* returns 0 (and zeroes the counters) if the instrumentation is not compiled in */
+int cmdoptions_get_stats(const struct cmdoptions* options, struct cmdoptions_stats* stats)
+{
+#ifdef CMDOPTIONS_ENABLE_STATS
+    *stats = options->stats;
+    return 1;
+#else
+    (void)options;
+    memset(stats, 0, sizeof(*stats));
+    return 0;
+#endif
+}
+
+/* the counters of the parses and queries of a result, those of its structure for the built-in result */
+int cmdoptions_result_get_stats(const struct cmdoptions_result* result, struct cmdoptions_stats* stats)
+{
+#ifdef CMDOPTIONS_ENABLE_STATS
+    *stats = *_RESULT_STATS(result);
+    return 1;
+#else
+    (void)result;
+    memset(stats, 0, sizeof(*stats));
+    return 0;
+#endif
+}
+
+#ifdef CMDOPTIONS_ENABLE_STATS
+static void _dump_stats(const struct cmdoptions* options)
+{
+    const struct cmdoptions_stats* stats = &options->stats;
+    fprintf(stderr, "cmdoptions: definitions: %lu (%.6f s)\n", stats->definitions, stats->definition_time);
+    fprintf(stderr, "cmdoptions: parses: %lu (%.6f s)\n", stats->parses, stats->parse_time);
+    fprintf(stderr, "cmdoptions: lookups: %lu (%lu hits, %lu misses, %lu entries scanned)\n", stats->lookups, stats->lookup_hits, stats->lookup_misses, stats->entries_scanned);
+    fprintf(stderr, "cmdoptions: help renders: %lu (%.6f s)\n", stats->help_renders, stats->help_time);
+    fprintf(stderr, "cmdoptions: allocations: %lu (%lu bytes, %lu bytes peak, %lu bytes still allocated)\n", stats->allocations,
+        (unsigned long)stats->bytes_allocated, (unsigned long)stats->peak_heap_size, (unsigned long)stats->heap_size);
+}
+#endif
+
+void cmdoptions_destroy(struct cmdoptions* options)
+{
+    size_t i;
+    struct cmdoptions_allocator allocator = options->allocator;
+#ifdef CMDOPTIONS_ENABLE_STATS
+    if(getenv("CMDOPTIONS_STATS"))
+    {
+        _dump_stats(options);
+    }
+#endif
+    _release_response_files(options->result);
+    if(options->snapshot)
+    {
+        _release_snapshot(options->snapshot, options->snapshot_size, options->snapshot_mapped, options->snapshot_table);
+    }
+    if(options->arena) /* everything (including the structure) lives in the arena */
+    {
+        _arena_destroy(&allocator, options->arena);
+        return;
+    }
+    _destroy_result(options->result);
+    _free(options, options->result);
+    for(i = 0; i < options->size; ++i)
+    {
+        _destroy_mode(options, options->modes[i]);
+    }
+    _free(options, options->modes);
+    _free(options, options->mode_index.slots);
+    _free(options, options->prehelpmsg);
+    _free(options, options->posthelpmsg);
+    allocator.deallocate(allocator.context, options);
+}
+
+void cmdoptions_exit(struct cmdoptions* options, int exitcode)
+{
+    cmdoptions_destroy(options);
+    exit(exitcode);
+}
+
+int cmdoptions_is_valid(const struct cmdoptions* options)
+{
+    return options->valid;
+}
+
+/* exempt by definition or queried through the built-in result */
+static int _was_checked(const struct cmdoptions* options, const struct option* option)
+{
+    return option->checked || _state(options->result, option)->was_checked;
+}
+
+int cmdoptions_assert_all_options_checked(const struct cmdoptions* options)
+{
+    size_t i;
+    size_t j;
+    struct mode* mode;
+    struct entry* entry;
+    struct option* option;
+    for(i = 0; i < options->size; ++i)
+    {
+        mode = options->modes[i];
+        for(j = 0; j < mode->entries_size; ++j)
+        {
+            entry = mode->entries[j];
+            if(entry->what == OPTION)
+            {
+                option = entry->value;
+                if(!_was_checked(options, option))
+                {
+                    if(option->long_identifier)
+                    {
+                        fprintf(stderr, "option '--%s' was no checked\n", option->long_identifier);
+                    }
+                    else
+                    {
+                        fprintf(stderr, "option '-%c' was no checked\n", option->short_identifier);
+                    }
+                    return 0;
+                }
+            }
+        }
+    }
+    return 1;
+}
+
+static int _check_capacity(struct cmdoptions* options, struct mode* mode)
+{
+    struct entry** tmp;
+    if(mode->entries_size + 1 > mode->entries_capacity)
+    {
+        tmp = _realloc(options, mode->entries, sizeof(*tmp) * mode->entries_capacity, sizeof(*tmp) * mode->entries_capacity * 2);
+        if(!tmp)
+        {
+            return 0;
+        }
+        mode->entries = tmp;
+        mode->entries_capacity *= 2;
+    }
+    return 1;
+}
+
+/* FNV-1a */
+static unsigned long _hash_string(const char* str)
+{
+    unsigned long hash = 2166136261UL;
+    while(*str)
+    {
+        hash ^= (unsigned char)*str;
+        hash *= 16777619UL;
+        ++str;
+    }
+    return hash;
+}
+
+/* FNV-1a with a seed and a final mix, truncated to 32 bits so that generated tables are portable */
+static unsigned long _hash_seeded(const char* str, unsigned long seed)
+{
+    unsigned long hash = (2166136261UL ^ seed) & 0xffffffffUL;
+    while(*str)
+    {
+        hash ^= (unsigned char)*str;
+        hash = (hash * 16777619UL) & 0xffffffffUL;
+        ++str;
+    }
+    hash ^= hash >> 16;
+    hash = (hash * 0x85ebca6bUL) & 0xffffffffUL;
+    hash ^= hash >> 13;
+    hash = (hash * 0xc2b2ae35UL) & 0xffffffffUL;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+/* perfect hash of a generated table: returns the only index that can hold the key (or -1), the caller compares the key */
+static int _static_lookup(const struct cmdoptions_static_hash* hash, const char* key)
+{
+    unsigned long seed = hash->seeds[_hash_seeded(key, 0) % hash->seeds_size];
+    return hash->slots[_hash_seeded(key, seed) % hash->slots_size];
+}
+
+static struct index_slot* _find_index_slot(struct index_slot* slots, size_t capacity, const char* key)
+{
+    size_t mask = capacity - 1;
+    size_t pos = _hash_string(key) & mask;
+    while(slots[pos].key && strcmp(slots[pos].key, key) != 0)
+    {
+        pos = (pos + 1) & mask;
+    }
+    return slots + pos;
+}
+
+static int _grow_index(struct cmdoptions* options, struct index* index)
+{
+    size_t i;
+    size_t capacity = index->capacity ? 2 * index->capacity : 8;
+    struct index_slot* slots = _alloc(options, capacity * sizeof(*slots));
+    if(!slots)
+    {
+        return 0;
+    }
+    for(i = 0; i < capacity; ++i)
+    {
+        slots[i].key = NULL;
+        slots[i].value = NULL;
+    }
+    for(i = 0; i < index->capacity; ++i)
+    {
+        if(index->slots[i].key)
+        {
+            *_find_index_slot(slots, capacity, index->slots[i].key) = index->slots[i];
+        }
+    }
+    _free(options, index->slots);
+    index->slots = slots;
+    index->capacity = capacity;
+    return 1;
+}
+
+/* existing keys are not replaced */
+static int _index_insert(struct cmdoptions* options, struct index* index, const char* key, void* value)
+{
+    struct index_slot* slot;
+    if(2 * (index->size + 1) > index->capacity)
+    {
+        if(!_grow_index(options, index))
+        {
+            return 0;
+        }
+    }
+    slot = _find_index_slot(index->slots, index->capacity, key);
+    if(!slot->key)
+    {
+        slot->key = key;
+        slot->value = value;
+        index->size += 1;
+    }
+    return 1;
+}
+
+static void* _index_lookup(struct cmdoptions_stats* stats, const struct index* index, const char* key)
+{
+    struct index_slot* slot;
+    if(!index->size)
+    {
+        return NULL;
+    }
+    slot = _find_index_slot(index->slots, index->capacity, key);
+    /* probe sequence length */
+    _STATS_ADD(stats, entries_scanned, (((size_t)(slot - index->slots) - _hash_string(key)) & (index->capacity - 1)) + 1);
+    return slot->value;
+}
+
+/*
+ * the first option registered for an identifier wins, as it did with the linear search
+ * the long identifier goes first, so a failed insert leaves nothing behind that points to the option
+ */
+static int _index_option(struct cmdoptions* options, struct mode* mode, struct option* option)
+{
+    struct option* target = option->aliased ? option->aliased : option;
+    if(option->long_identifier && !_index_insert(options, &mode->long_index, option->long_identifier, target))
+    {
+        return 0;
+    }
+    if(option->short_identifier && !mode->short_index[(unsigned char)option->short_identifier])
+    {
+        mode->short_index[(unsigned char)option->short_identifier] = target;
+    }
+    return 1;
+}
+
+/* width of '-s,--long' in the help message */
+static size_t _option_width(const struct option* option)
+{
+    if(option->short_identifier && !option->long_identifier)
+    {
+        return 2; /* 2: -%c */
+    }
+    else if(!option->short_identifier && option->long_identifier)
+    {
+        return option->long_length + 2; /* + 2: -- */
+    }
+    else
+    {
+        return 2 + 1 + option->long_length + 2; /* +1: , */
+    }
+}
+
+static void _update_optwidth(struct cmdoptions* options, const struct option* option)
+{
+    size_t width = _option_width(option);
+    if(width > options->optwidth)
+    {
+        options->optwidth = width;
+    }
+}
+
+static int _add_entry(struct cmdoptions* options, struct mode* mode, struct entry* entry)
+{
+    _definition_changed(options);
+    if(!_check_capacity(options, mode))
+    {
+        return 0;
+    }
+    if(entry->what == OPTION)
+    {
+        if(!_index_option(options, mode, entry->value))
+        {
+            return 0;
+        }
+        _update_optwidth(options, entry->value);
+    }
+    mode->entries[mode->entries_size] = entry;
+    mode->entries_size += 1;
+    return 1;
+}
+
+static struct option* _get_static_option(struct cmdoptions_stats* stats, const struct mode* mode, char short_identifier, const char* long_identifier)
+{
+    int i;
+    struct option* option;
+    _STATS_ADD(stats, entries_scanned, 1);
+    if(long_identifier)
+    {
+        i = _static_lookup(&mode->table->long_hash, long_identifier);
+        if(i < 0 || strcmp(mode->table->entries[i].long_identifier, long_identifier) != 0)
+        {
+            return NULL;
+        }
+    }
+    else
+    {
+        i = mode->table->short_table[(unsigned char)short_identifier];
+        if(i < 0)
+        {
+            return NULL;
+        }
+    }
+    option = mode->static_entries[i].value;
+    return option->aliased ? option->aliased : option;
+}
+
+static struct option* _get_option(struct cmdoptions* options, struct mode* mode, char short_identifier, const char* long_identifier)
+{
+    struct option* option = NULL;
+    if(mode->table)
+    {
+        option = _get_static_option(_STATS(options), mode, short_identifier, long_identifier);
+    }
+    if(!option)
+    {
+        option = long_identifier ? _index_lookup(_STATS(options), &mode->long_index, long_identifier) : mode->short_index[(unsigned char)short_identifier];
+    }
+    _STATS_LOOKUP(_STATS(options), option);
+    return option;
+}
+
+/* lookups while parsing or querying a result */
+static const struct option* _get_const_option(const struct cmdoptions_result* result, const struct mode* mode, char short_identifier, const char* long_identifier)
+{
+    const struct option* option = NULL;
+    if(mode->table)
+    {
+        option = _get_static_option(_RESULT_STATS(result), mode, short_identifier, long_identifier);
+    }
+    if(!option)
+    {
+        option = long_identifier ? _index_lookup(_RESULT_STATS(result), &mode->long_index, long_identifier) : mode->short_index[(unsigned char)short_identifier];
+    }
+    _STATS_LOOKUP(_RESULT_STATS(result), option);
+    return option;
+}
+
+static int _static_mode(const struct cmdoptions* options, struct cmdoptions_stats* stats, const char* modename)
+{
+    int i;
+    if(!options->table)
+    {
+        return -1;
+    }
+    _STATS_ADD(stats, entries_scanned, 1);
+    i = _static_lookup(&options->table->mode_hash, modename);
+    if(i <= 0 || strcmp(options->table->modes[i].identifier, modename) != 0) /* 0 is the base mode */
+    {
+        return -1;
+    }
+    return i;
+}
+
+static struct mode* _find_mode(struct cmdoptions* options, const char* modename)
+{
+    int i = _static_mode(options, _STATS(options), modename);
+    struct mode* mode = i > 0 ? options->modes[i] : _index_lookup(_STATS(options), &options->mode_index, modename);
+    _STATS_LOOKUP(_STATS(options), mode);
+    return mode;
+}
+
+static const struct mode* _find_const_mode(const struct cmdoptions_result* result, const char* modename)
+{
+    const struct cmdoptions* options = result->options;
+    int i = _static_mode(options, _RESULT_STATS(result), modename);
+    const struct mode* mode = i > 0 ? options->modes[i] : _index_lookup(_RESULT_STATS(result), &options->mode_index, modename);
+    _STATS_LOOKUP(_RESULT_STATS(result), mode);
+    return mode;
+}
+
+static int _add_section(struct cmdoptions* options, struct mode* mode, const char* name)
+{
+    struct entry* entry;
+    struct section* section;
+    if(_frozen(options))
+    {
+        return 0;
+    }
+    section = _alloc(options, sizeof(*section));
+    if(!section)
+    {
+        return 0;
+    }
+    section->name = _definition_string(options, name);
+    section->name_static = options->static_strings;
+    if(!section->name)
+    {
+        _free(options, section);
+        return 0;
+    }
+    entry = _alloc(options, sizeof(*entry));
+    if(!entry)
+    {
+        if(!section->name_static)
+        {
+            _free(options, section->name);
+        }
+        _free(options, section);
+        return 0;
+    }
+    entry->what = SECTION;
+    entry->value = section;
+    if(!_add_entry(options, mode, entry))
+    {
+        _destroy_entry(options, entry);
+        return 0;
+    }
+    return 1;
+}
+
+int cmdoptions_mode_add_section(struct cmdoptions* options, const char* modename, const char* name)
+{
+    struct mode* mode;
+    int ret;
+    _STATS_TIMER(start)
+    _STATS_START(start);
+    mode = _find_mode(options, modename);
+    ret = mode ? _add_section(options, mode, name) : 0;
+    _STATS_STOP(_STATS(options), definitions, definition_time, start);
+    return ret;
+}
+
+int cmdoptions_add_section(struct cmdoptions* options, const char* name)
+{
+    struct mode* mode = options->modes[0]; /* base mode */
+    int ret;
+    _STATS_TIMER(start)
+    _STATS_START(start);
+    ret = _add_section(options, mode, name);
+    _STATS_STOP(_STATS(options), definitions, definition_time, start);
+    return ret;
+}
+
+static struct entry* _create_option(struct cmdoptions* options, char short_identifier, const char* long_identifier, int numargs, const char* help)
+{
+    struct entry* entry;
+    struct option* option;
+    if(_frozen(options) || !_reserve_result(options->result, options->noptions + 1, options->size))
+    {
+        return NULL;
+    }
+    if((numargs & ARG_TYPE_MASK) > DURATION_ARG)
+    {
+        fprintf(stderr, "unknown argument type of command-line option '%s'\n", long_identifier ? long_identifier : "");
+        return NULL;
+    }
+    option = _alloc(options, sizeof(*option));
+    if(!option)
+    {
+        return NULL;
+    }
+    option->short_identifier = short_identifier;
+    option->long_identifier = long_identifier;
+    option->long_length = long_identifier ? strlen(long_identifier) : 0;
+    option->numargs = numargs;
+    option->default_argument = NULL;
+    option->default_static = 0;
+    option->checked = 0;
+    option->help = help;
+    option->aliased = NULL;
+    option->id = options->noptions;
+    options->noptions += 1;
+    entry = _alloc(options, sizeof(*entry));
+    if(!entry)
+    {
+        _free(options, option);
+        return NULL;
+    }
+    entry->value = option;
+    entry->what = OPTION;
+    return entry;
+}
+
+static struct mode* _get_basemode(struct cmdoptions* options)
+{
+    return options->modes[0];
+}
+
+static const struct mode* _get_const_basemode(const struct cmdoptions* options)
+{
+    return options->modes[0];
+}
+
+static int _add_mode(struct cmdoptions* options, const char* modename)
+{
+    struct mode* mode;
+    struct mode** modes;
+    char* identifier;
+    if(_frozen(options) || _find_mode(options, modename))
+    {
+        return 0;
+    }
+    _definition_changed(options);
+    if(!_reserve_result(options->result, options->noptions, options->size + 1))
+    {
+        return 0;
+    }
+    if(options->size + 1 > options->capacity)
+    {
+        modes = _realloc(options, options->modes, options->capacity * sizeof(*options->modes), 2 * options->capacity * sizeof(*options->modes));
+        if(!modes)
+        {
+            return 0;
+        }
+        options->modes = modes;
+        options->capacity *= 2;
+    }
+    identifier = _definition_string(options, modename);
+    if(!identifier)
+    {
+        return 0;
+    }
+    mode = _create_mode(options, identifier);
+    if(!mode)
+    {
+        if(!options->static_strings)
+        {
+            _free(options, identifier);
+        }
+        return 0;
+    }
+    mode->identifier_static = options->static_strings;
+    if(!_index_insert(options, &options->mode_index, mode->identifier, mode))
+    {
+        _destroy_mode(options, mode);
+        return 0;
+    }
+    options->modes[options->size] = mode;
+    options->size += 1;
+    return 1;
+}
+
+int cmdoptions_add_mode(struct cmdoptions* options, const char* modename)
+{
+    int ret;
+    _STATS_TIMER(start)
+    _STATS_START(start);
+    ret = _add_mode(options, modename);
+    _STATS_STOP(_STATS(options), definitions, definition_time, start);
+    return ret;
+}
+
+static int _add_alias(struct cmdoptions* options, const char* long_aliased_identifier, char short_identifier, const char* long_identifier, const char* help)
+{
+    struct entry* entry;
+    struct mode* basemode = _get_basemode(options);
+    struct option* alias = _get_option(options, basemode, 0, long_aliased_identifier);
+
+    entry = _create_option(options, short_identifier, long_identifier, 0, help); /* num_args will never be used */
+    if(!entry)
+    {
+        return 0;
+    }
+    ((struct option*)entry->value)->aliased = alias;
+    if(!_add_entry(options, basemode, entry))
+    {
+        _destroy_entry(options, entry);
+        return 0;
+    }
+    return 1;
+}
+
+int cmdoptions_add_alias(struct cmdoptions* options, const char* long_aliased_identifier, char short_identifier, const char* long_identifier, const char* help)
+{
+    int ret;
+    _STATS_TIMER(start)
+    _STATS_START(start);
+    ret = _add_alias(options, long_aliased_identifier, short_identifier, long_identifier, help);
+    _STATS_STOP(_STATS(options), definitions, definition_time, start);
+    return ret;
+}
+
+static int _add_option_checked(struct cmdoptions* options, char short_identifier, const char* long_identifier, int numargs, const char* help)
+{
+    struct mode* basemode = _get_basemode(options);
+    struct entry* entry = _create_option(options, short_identifier, long_identifier, numargs, help);
+    if(!entry)
+    {
+        return 0;
+    }
+    ((struct option*)entry->value)->checked = 1;
+    if(!_add_entry(options, basemode, entry))
+    {
+        _destroy_entry(options, entry);
+        return 0;
+    }
+    return 1;
+}
+
+static int _add_option(struct cmdoptions* options, char short_identifier, const char* long_identifier, int numargs, const char* help)
+{
+    struct mode* basemode = _get_basemode(options);
+    struct entry* entry = _create_option(options, short_identifier, long_identifier, numargs, help);
+    if(!entry)
+    {
+        return 0;
+    }
+    if(!_add_entry(options, basemode, entry))
+    {
+        _destroy_entry(options, entry);
+        return 0;
+    }
+    return 1;
+}
+
+int cmdoptions_add_option(struct cmdoptions* options, char short_identifier, const char* long_identifier, int numargs, const char* help)
+{
+    int ret;
+    _STATS_TIMER(start)
+    _STATS_START(start);
+    ret = _add_option(options, short_identifier, long_identifier, numargs, help);
+    _STATS_STOP(_STATS(options), definitions, definition_time, start);
+    return ret;
+}
+
+static int _mode_add_option(struct cmdoptions* options, const char* modename, char short_identifier, const char* long_identifier, int numargs, const char* help)
+{
+    struct mode* mode = _find_mode(options, modename);
+    struct entry* entry;
+    if(!mode)
+    {
+        return 0;
+    }
+    entry = _create_option(options, short_identifier, long_identifier, numargs, help);
+    if(!entry)
+    {
+        return 0;
+    }
+    if(!_add_entry(options, mode, entry))
+    {
+        _destroy_entry(options, entry);
+        return 0;
+    }
+    return 1;
+}
+
+int cmdoptions_mode_add_option(struct cmdoptions* options, const char* modename, char short_identifier, const char* long_identifier, int numargs, const char* help)
+{
+    int ret;
+    _STATS_TIMER(start)
+    _STATS_START(start);
+    ret = _mode_add_option(options, modename, short_identifier, long_identifier, numargs, help);
+    _STATS_STOP(_STATS(options), definitions, definition_time, start);
+    return ret;
+}
+
+static int _add_option_default(struct cmdoptions* options, char short_identifier, const char* long_identifier, int numargs, const char* default_arg, const char* help)
+{
+    struct mode* basemode = _get_basemode(options);
+    struct entry* entry = _create_option(options, short_identifier, long_identifier, numargs, help);
+    struct option* option;
+    char* arg;
+    char** args;
+    if(!entry)
+    {
+        return 0;
+    }
+    option = entry->value;
+    if((numargs & ARG_TYPE_MASK) && !_convert_argument(numargs, default_arg, &option->default_value))
+    {
+        fprintf(stderr, "%s '%s' as default of command-line option '%s'\n", _type_error(numargs), default_arg, long_identifier ? long_identifier : "");
+        _destroy_entry(options, entry);
+        return 0;
+    }
+    arg = _definition_string(options, default_arg);
+    if(!arg)
+    {
+        _destroy_entry(options, entry);
+        return 0;
+    }
+    option->default_static = options->static_strings;
+    if(numargs & MULTI_ARGS)
+    {
+        args = _alloc(options, 2 * sizeof(*args));
+        if(!args)
+        {
+            if(!option->default_static)
+            {
+                _free(options, arg);
+            }
+            _destroy_entry(options, entry);
+            return 0;
+        }
+        args[0] = arg;
+        args[1] = NULL;
+        option->default_argument = args;
+    }
+    else
+    {
+        option->default_argument = arg;
+    }
+    if(!_add_entry(options, basemode, entry))
+    {
+        _destroy_entry(options, entry);
+        return 0;
+    }
+    return 1;
+}
+
+int cmdoptions_add_option_default(struct cmdoptions* options, char short_identifier, const char* long_identifier, int numargs, const char* default_arg, const char* help)
+{
+    int ret;
+    _STATS_TIMER(start)
+    _STATS_START(start);
+    ret = _add_option_default(options, short_identifier, long_identifier, numargs, default_arg, help);
+    _STATS_STOP(_STATS(options), definitions, definition_time, start);
+    return ret;
+}
+
+static void _append_to_message(struct cmdoptions* options, char** message, const char* msg)
+{
+    int empty = (*message)[0] == 0;
+    size_t oldlen = strlen(*message);
+    size_t len = oldlen + strlen(msg);
+    char* str;
+    if(_frozen(options))
+    {
+        return;
+    }
+    _definition_changed(options);
+    if(!empty)
+    {
+        len = len + 1; /* +1: for newline */
+    }
+    str = _realloc(options, *message, oldlen + 1, len + 1);
+    if(!str)
+    {
+        options->valid = 0;
+        return;
+    }
+    if(!empty)
+    {
+        strcat(str, "\n");
+    }
+    strcat(str, msg);
+    *message = str;
+}
+
+void cmdoptions_prepend_help_message(struct cmdoptions* options, const char* msg)
+{
+    _append_to_message(options, &options->prehelpmsg, msg);
+}
+
+void cmdoptions_append_help_message(struct cmdoptions* options, const char* msg)
+{
+    _append_to_message(options, &options->posthelpmsg, msg);
+}
+
+static void _print_help_entry(struct print_sink* sink, const struct entry* entry, unsigned int startskip, unsigned int leftmargin, unsigned int textwidth, unsigned int optwidth, unsigned int helpsep, int narrow)
+{
+    unsigned int count;
+    if(entry->what == SECTION)
+    {
+        struct section* section = entry->value;
+        print_sink_puts(sink, section->name);
+        print_sink_putc(sink, '\n');
+    }
+    else
+    {
+        struct option* option = entry->value;
+        print_sink_spaces(sink, startskip);
+        count = optwidth;
+        if(option->short_identifier)
+        {
+            print_sink_putc(sink, '-');
+            print_sink_putc(sink, option->short_identifier);
+            count -= 2;
+        }
+        if(option->short_identifier && option->long_identifier)
+        {
+            print_sink_putc(sink, ',');
+            count -= 1;
+        }
+        if(option->long_identifier)
+        {
+            print_sink_putc(sink, '-');
+            print_sink_putc(sink, '-');
+            print_sink_puts(sink, option->long_identifier);
+            count -= (2 + option->long_length);
+        }
+        if(narrow)
+        {
+            print_sink_putc(sink, '\n');
+            print_sink_spaces(sink, 2 * startskip);
+        }
+        else
+        {
+            print_sink_spaces(sink, helpsep + count);
+        }
+        leftmargin = narrow ? 2 * startskip : startskip + optwidth + helpsep;
+        print_wrapped_paragraph_sink(sink, option->help, textwidth, leftmargin);
+    }
+}
+
+size_t _number_of_passed_options(const struct cmdoptions* options)
+{
+    size_t count = 0;
+    struct mode* mode;
+    size_t m;
+    size_t i;
+    for(m = 0; m < options->size; ++m)
+    {
+        mode = options->modes[m];
+        for(i = 0; i < mode->entries_size; ++i)
+        {
+            const struct entry* entry = mode->entries[i];
+            if(entry->what == OPTION)
+            {
+                struct option* option = entry->value;
+                if(_state(options->result, option)->was_provided)
+                {
+                    ++count;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+static const struct cmdoptions_static_help* _find_static_help(const struct cmdoptions* options, unsigned int displaywidth, int narrow)
+{
+    size_t i;
+    for(i = 0; i < options->static_help_size; ++i)
+    {
+        if(options->static_help[i].width == displaywidth && options->static_help[i].narrow == narrow)
+        {
+            return &options->static_help[i];
+        }
+    }
+    return NULL;
+}
+
+static int _no_positional_parameters(const struct cmdoptions* options);
+static int _render_help(const struct cmdoptions* options, struct print_sink* sink, unsigned int displaywidth, int narrow);
+int cmdoptions_help_sink(const struct cmdoptions* options, struct print_sink* sink)
+{
+    unsigned int displaywidth = print_get_screen_width();
+    int narrow = options->force_narrow_mode || (displaywidth < 100); /* FIXME: make dynamic (dependent on maximum word width or something) */
+    const struct cmdoptions_static_help* help = NULL;
+    int ret = 1;
+    _STATS_TIMER(start)
+    _STATS_START(start);
+    if(_no_positional_parameters(options))
+    {
+        help = _find_static_help(options, displaywidth, narrow);
+    }
+    if(help)
+    {
+        print_sink_write(sink, help->text, help->length);
+    }
+    else
+    {
+        ret = _render_help(options, sink, displaywidth, narrow);
+    }
+    _STATS_STOP(_STATS(options), help_renders, help_time, start);
+    return ret;
+}
+
+static int _render_help(const struct cmdoptions* options, struct print_sink* sink, unsigned int displaywidth, int narrow)
+{
+    /* FIXME: include modes */
+    unsigned int optwidth = 0;
+    unsigned int i;
+    unsigned int startskip = 4;
+    unsigned int helpsep = 4;
+    unsigned int leftmargin = 0;
+    unsigned int rightmargin = 1;
+    unsigned int offset;
+    unsigned int textwidth;
+    size_t m;
+    const struct mode* mode;
+    const char** pospar;
+
+    optwidth = (unsigned int)options->optwidth;
+
+    offset = narrow ? 2 * startskip : optwidth + startskip + helpsep;
+    textwidth = displaywidth - offset - leftmargin - rightmargin;
+
+    if(!_no_positional_parameters(options)) /* additional options are present, only print those */
+    {
+        mode = _get_const_basemode(options);
+        pospar = cmdoptions_get_positional_parameters(options);
+        while(*pospar)
+        {
+            int printed = 0;
+            for(i = 0; i < mode->entries_size; ++i)
+            {
+                const struct entry* entry = mode->entries[i];
+                if(entry->what == OPTION)
+                {
+                    struct option* option = entry->value;
+                    if((*pospar)[1] == 0) /* single character */
+                    {
+                        if(**pospar == option->short_identifier)
+                        {
+                            printed = 1;
+                            _print_help_entry(sink, entry, startskip, leftmargin, textwidth, optwidth, helpsep, narrow);
+                        }
+                    }
+                    else if(((*pospar)[0] == '-') && ((*pospar)[1] != 0) && ((*pospar)[2] == 0)) /* single character with dash */
+                    {
+                        if((*pospar)[1] == option->short_identifier)
+                        {
+                            printed = 1;
+                            _print_help_entry(sink, entry, startskip, leftmargin, textwidth, optwidth, helpsep, narrow);
+                        }
+                    }
+                    else /* multi-character */
+                    {
+                        const char* identifier = *pospar;
+                        if(((*pospar)[0] == '-') && (*pospar)[1] == '-') /* starts with two dashes */
+                        {
+                            identifier = *pospar + 2;
+                        }
+                        if(strstr(option->long_identifier, identifier)) /* (partial) match */
+                        {
+                            printed = 1;
+                            _print_help_entry(sink, entry, startskip, leftmargin, textwidth, optwidth, helpsep, narrow);
+                        }
+                    }
+                }
+            }
+            if(!printed)
+            {
+                print_sink_flush(sink); /* keep the order of stdout and stderr */
+                fprintf(stderr, "help: option '%s' not found\n", *pospar);
+                return 0;
+            }
+            ++pospar;
+        }
+        /* FIXME: also enable for modes, although cmdline syntax is unclear */
+    }
+    else /* no additional options, print all */
+    {
+        print_sink_puts(sink, options->prehelpmsg);
+        print_sink_putc(sink, '\n');
+        print_sink_puts(sink, "list of command line options:\n\n");
+        if(options->size > 1)
+        {
+            print_sink_puts(sink, "generic options:\n");
+        }
+        mode = _get_const_basemode(options);
+        for(i = 0; i < mode->entries_size; ++i)
+        {
+            const struct entry* entry = mode->entries[i];
+            _print_help_entry(sink, entry, startskip, leftmargin, textwidth, optwidth, helpsep, narrow);
+        }
+        print_sink_putc(sink, '\n');
+
+        for(m = 1; m < options->size; ++m)
+        {
+            mode = options->modes[m];
+            print_sink_puts(sink, mode->identifier);
+            print_sink_puts(sink, ":\n");
+            for(i = 0; i < mode->entries_size; ++i)
+            {
+                const struct entry* entry = mode->entries[i];
+                _print_help_entry(sink, entry, startskip, leftmargin, textwidth, optwidth, helpsep, narrow);
+            }
+            print_sink_putc(sink, '\n');
+        }
+        print_sink_puts(sink, options->posthelpmsg);
+        print_sink_putc(sink, '\n');
+    }
+    return 1;
+}
+
+/* the help message is assembled in memory and written at once */
+int cmdoptions_help(const struct cmdoptions* options)
+{
+    struct print_sink sink;
+    int ret;
+    print_sink_init_file(&sink, stdout);
+    print_sink_set_allocator(&sink, options->allocator.reallocate, options->allocator.deallocate, options->allocator.context);
+    ret = cmdoptions_help_sink(options, &sink);
+    print_sink_flush(&sink);
+    print_sink_release(&sink);
+    return ret;
+}
+
+static void _print_with_correct_escape_sequences(struct print_sink* sink, const char* str)
+{
+    while(*str)
+    {
+        if(*str == '\\')
+        {
+            print_sink_putc(sink, '\\');
+        }
+        print_sink_putc(sink, *str);
+        ++str;
+    }
+    print_sink_putc(sink, '\n');
+}
+
+void cmdoptions_export_manpage_sink(const struct cmdoptions* options, struct print_sink* sink)
+{
+    unsigned int m;
+    unsigned int i;
+    struct mode* mode;
+    if(options->static_manpage)
+    {
+        print_sink_puts(sink, options->static_manpage);
+        return;
+    }
+    for(m = 0; m < options->size; ++m)
+    {
+        mode = options->modes[m];
+        for(i = 0; i < mode->entries_size; ++i)
+        {
+            struct entry* entry = mode->entries[i];
+            if(entry->what == OPTION)
+            {
+                struct option* option = entry->value;
+                print_sink_puts(sink, ".IP \"\\fB\\");
+                if(option->short_identifier && option->long_identifier)
+                {
+                    print_sink_putc(sink, '-');
+                    print_sink_putc(sink, option->short_identifier);
+                    print_sink_putc(sink, ',');
+                    print_sink_putc(sink, '-');
+                    print_sink_putc(sink, '-');
+                    print_sink_puts(sink, option->long_identifier);
+                }
+                else if(option->short_identifier)
+                {
+                    print_sink_putc(sink, '-');
+                    print_sink_putc(sink, option->short_identifier);
+                }
+                else if(option->long_identifier)
+                {
+                    print_sink_putc(sink, '-');
+                    print_sink_putc(sink, '-');
+                    print_sink_puts(sink, option->long_identifier);
+                }
+                print_sink_puts(sink, "\\fR \" 4\n");
+                _print_with_correct_escape_sequences(sink, option->help);
+            }
+            else /* section */
+            {
+                struct section* section = entry->value;
+                print_sink_puts(sink, ".SS ");
+                print_sink_puts(sink, section->name);
+                print_sink_putc(sink, '\n');
+            }
+        }
+    }
+}
+
+void cmdoptions_export_manpage(const struct cmdoptions* options)
+{
+    struct print_sink sink;
+    print_sink_init_file(&sink, stdout);
+    print_sink_set_allocator(&sink, options->allocator.reallocate, options->allocator.deallocate, options->allocator.context);
+    cmdoptions_export_manpage_sink(options, &sink);
+    print_sink_flush(&sink);
+    print_sink_release(&sink);
+}
+
+/* static table generation */
+struct hash_bucket {
+    size_t size;
+    size_t index;
+};
+
+/* largest buckets first */
+static int _compare_buckets(const void* lhs, const void* rhs)
+{
+    size_t l = ((const struct hash_bucket*)lhs)->size;
+    size_t r = ((const struct hash_bucket*)rhs)->size;
+    return l < r ? 1 : (l > r ? -1 : 0);
+}
+
+/*
+ * hash and displace: the keys are distributed to buckets, then every bucket (largest first) gets a seed that places all of its keys in free slots
+ * seeds_size must be size / 2 + 1, slots_size must be size + size / 4 + 1
+ */
+static int _build_perfect_hash(const struct cmdoptions_allocator* allocator, const char* const * keys, const int* values, size_t size, unsigned long* seeds, int* slots)
+{
+    size_t seeds_size = size / 2 + 1;
+    size_t slots_size = size + size / 4 + 1;
+    struct hash_bucket* buckets = allocator->allocate(allocator->context, seeds_size * sizeof(*buckets));
+    size_t* key_bucket = allocator->allocate(allocator->context, (size + 1) * sizeof(*key_bucket));
+    size_t* placed = allocator->allocate(allocator->context, (size + 1) * sizeof(*placed));
+    size_t b;
+    size_t k;
+    size_t nplaced;
+    size_t slot;
+    unsigned long seed;
+    int ret = 1;
+    if(!buckets || !key_bucket || !placed)
+    {
+        ret = 0;
+        goto CLEANUP;
+    }
+    for(slot = 0; slot < slots_size; ++slot)
+    {
+        slots[slot] = -1;
+    }
+    for(b = 0; b < seeds_size; ++b)
+    {
+        seeds[b] = 0;
+        buckets[b].size = 0;
+        buckets[b].index = b;
+    }
+    for(k = 0; k < size; ++k)
+    {
+        key_bucket[k] = _hash_seeded(keys[k], 0) % seeds_size;
+        buckets[key_bucket[k]].size += 1;
+    }
+    qsort(buckets, seeds_size, sizeof(*buckets), _compare_buckets);
+    for(b = 0; b < seeds_size && buckets[b].size; ++b)
+    {
+        for(seed = 1; seed < 1000000UL; ++seed)
+        {
+            nplaced = 0;
+            for(k = 0; k < size; ++k)
+            {
+                if(key_bucket[k] != buckets[b].index)
+                {
+                    continue;
+                }
+                slot = _hash_seeded(keys[k], seed) % slots_size;
+                if(slots[slot] != -1)
+                {
+                    break;
+                }
+                slots[slot] = values[k];
+                placed[nplaced] = slot;
+                nplaced += 1;
+            }
+            if(k == size) /* all keys of the bucket found a free slot */
+            {
+                seeds[buckets[b].index] = seed;
+                break;
+            }
+            while(nplaced > 0)
+            {
+                nplaced -= 1;
+                slots[placed[nplaced]] = -1;
+            }
+        }
+        if(seed == 1000000UL)
+        {
+            fprintf(stderr, "could not find a perfect hash for %lu keys\n", (unsigned long)size);
+            ret = 0;
+            goto CLEANUP;
+        }
+    }
+CLEANUP:
+    allocator->deallocate(allocator->context, buckets);
+    allocator->deallocate(allocator->context, key_bucket);
+    allocator->deallocate(allocator->context, placed);
+    return ret;
+}
+
+static void _print_c_characters(const char* str, size_t size)
+{
+    while(size > 0)
+    {
+        unsigned char ch = *str;
+        if(ch == '"' || ch == '\\' || ch == '?') /* '?': no trigraphs */
+        {
+            putchar('\\');
+            putchar(ch);
+        }
+        else if(ch == '\n')
+        {
+            fputs("\\n", stdout);
+        }
+        else if(ch == '\t')
+        {
+            fputs("\\t", stdout);
+        }
+        else if(ch < 32 || ch == 127)
+        {
+            printf("\\%03o", ch);
+        }
+        else
+        {
+            putchar(ch);
+        }
+        ++str;
+        --size;
+    }
+}
+
+static void _print_c_string(const char* str)
+{
+    if(!str)
+    {
+        fputs("NULL", stdout);
+        return;
+    }
+    putchar('"');
+    _print_c_characters(str, strlen(str));
+    putchar('"');
+}
+
+/* long text as one string literal per line */
+static void _print_c_text(const char* str, size_t size, const char* indent)
+{
+    const char* newline;
+    while(size > 0)
+    {
+        newline = memchr(str, '\n', size);
+        newline = newline ? newline + 1 : str + size;
+        printf("\n%s\"", indent);
+        _print_c_characters(str, newline - str);
+        putchar('"');
+        size -= newline - str;
+        str = newline;
+    }
+}
+
+static void _print_c_char(char ch)
+{
+    if(isalnum((unsigned char)ch) || ch == '-' || ch == '_' || ch == '+' || ch == '.')
+    {
+        printf("'%c'", ch);
+    }
+    else
+    {
+        printf("%d", ch);
+    }
+}
+
+static void _print_hash(const char* name, const char* what, unsigned int m, const unsigned long* seeds, const int* slots, size_t size)
+{
+    size_t i;
+    printf("static const unsigned long %s_%s_seeds_%u[] = {", name, what, m);
+    for(i = 0; i < size / 2 + 1; ++i)
+    {
+        printf("%s%s%luUL", i ? "," : "", i % 8 ? " " : "\n    ", seeds[i]);
+    }
+    printf("\n};\n");
+    printf("static const int %s_%s_slots_%u[] = {", name, what, m);
+    for(i = 0; i < size + size / 4 + 1; ++i)
+    {
+        printf("%s%s%d", i ? "," : "", i % 16 ? " " : "\n    ", slots[i]);
+    }
+    printf("\n};\n");
+}
+
+static int _entry_index(const struct mode* mode, const struct option* option)
+{
+    size_t i;
+    for(i = 0; i < mode->entries_size; ++i)
+    {
+        if(mode->entries[i]->value == option)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static const char* _single_default(const struct option* option)
+{
+    if(option->default_argument && (option->numargs & MULTI_ARGS))
+    {
+        return *(char**)option->default_argument;
+    }
+    return option->default_argument;
+}
+
+/* lookup tables of a mode, shared by static tables and snapshots */
+struct mode_tables {
+    int short_table[256];
+    const char** keys;
+    int* values;
+    size_t nkeys;
+    unsigned long* seeds; /* nkeys / 2 + 1 */
+    int* slots; /* nkeys + nkeys / 4 + 1 */
+};
+
+static void _free_mode_tables(const struct cmdoptions_allocator* allocator, struct mode_tables* tables)
+{
+    allocator->deallocate(allocator->context, tables->keys);
+    allocator->deallocate(allocator->context, tables->values);
+    allocator->deallocate(allocator->context, tables->seeds);
+    allocator->deallocate(allocator->context, tables->slots);
+}
+
+/* they must give the same results as the indices of the mode */
+static int _build_mode_tables(const struct cmdoptions_allocator* allocator, const struct mode* mode, struct mode_tables* tables)
+{
+    size_t i;
+    size_t j;
+    const struct option* option;
+    tables->keys = allocator->allocate(allocator->context, (mode->entries_size + 1) * sizeof(*tables->keys));
+    tables->values = allocator->allocate(allocator->context, (mode->entries_size + 1) * sizeof(*tables->values));
+    tables->seeds = allocator->allocate(allocator->context, (mode->entries_size / 2 + 1) * sizeof(*tables->seeds));
+    tables->slots = allocator->allocate(allocator->context, (mode->entries_size + mode->entries_size / 4 + 1) * sizeof(*tables->slots));
+    tables->nkeys = 0;
+    if(!tables->keys || !tables->values || !tables->seeds || !tables->slots)
+    {
+        _free_mode_tables(allocator, tables);
+        return 0;
+    }
+    for(i = 0; i < 256; ++i)
+    {
+        tables->short_table[i] = -1;
+    }
+    for(i = 0; i < mode->entries_size; ++i)
+    {
+        if(mode->entries[i]->what != OPTION)
+        {
+            continue;
+        }
+        option = mode->entries[i]->value;
+        /* the first option registered for an identifier wins */
+        if(option->short_identifier && tables->short_table[(unsigned char)option->short_identifier] < 0)
+        {
+            tables->short_table[(unsigned char)option->short_identifier] = i;
+        }
+        if(option->long_identifier)
+        {
+            for(j = 0; j < tables->nkeys && strcmp(tables->keys[j], option->long_identifier) != 0; ++j)
+            {
+            }
+            if(j == tables->nkeys)
+            {
+                tables->keys[tables->nkeys] = option->long_identifier;
+                tables->values[tables->nkeys] = i;
+                tables->nkeys += 1;
+            }
+        }
+    }
+    if(!_build_perfect_hash(allocator, tables->keys, tables->values, tables->nkeys, tables->seeds, tables->slots))
+    {
+        _free_mode_tables(allocator, tables);
+        return 0;
+    }
+    return 1;
+}
+
+static int _export_static_mode(const struct cmdoptions* options, const struct mode* mode, const char* name, unsigned int m, size_t* nkeys)
+{
+    size_t i;
+    struct mode_tables tables;
+    if(!_build_mode_tables(&options->allocator, mode, &tables))
+    {
+        return 0;
+    }
+    if(mode->entries_size)
+    {
+        printf("static const struct cmdoptions_static_entry %s_entries_%u[] = {\n", name, m);
+    }
+    for(i = 0; i < mode->entries_size; ++i)
+    {
+        const struct entry* entry = mode->entries[i];
+        if(entry->what == OPTION)
+        {
+            const struct option* option = entry->value;
+            fputs("    { CMDOPTIONS_STATIC_OPTION, ", stdout);
+            _print_c_char(option->short_identifier);
+            fputs(", ", stdout);
+            _print_c_string(option->long_identifier);
+            printf(", %d, ", option->numargs);
+            _print_c_string(_single_default(option));
+            fputs(", ", stdout);
+            _print_c_string(option->help);
+            printf(", %d, %d }", option->aliased ? _entry_index(mode, option->aliased) : -1, _was_checked(options, option));
+        }
+        else /* section */
+        {
+            const struct section* section = entry->value;
+            fputs("    { CMDOPTIONS_STATIC_SECTION, 0, ", stdout);
+            _print_c_string(section->name);
+            fputs(", 0, NULL, NULL, -1, 0 }", stdout);
+        }
+        printf("%s\n", i + 1 < mode->entries_size ? "," : "");
+    }
+    if(mode->entries_size)
+    {
+        printf("};\n");
+    }
+    printf("static const int %s_short_%u[256] = {", name, m);
+    for(i = 0; i < 256; ++i)
+    {
+        printf("%s%s%d", i ? "," : "", i % 16 ? " " : "\n    ", tables.short_table[i]);
+    }
+    printf("\n};\n");
+    _print_hash(name, "long", m, tables.seeds, tables.slots, tables.nkeys);
+    *nkeys = tables.nkeys;
+    _free_mode_tables(&options->allocator, &tables);
+    return 1;
+}
+
+/* display widths for which the help message is rendered at build time */
+static const unsigned int _static_help_widths[] = { 80, 100, 120, 160 };
+
+static int _export_static_help(const struct cmdoptions* options, const char* name, size_t* nhelp)
+{
+    struct print_sink sink;
+    size_t i;
+    int narrow;
+    *nhelp = 0;
+    printf("static const struct cmdoptions_static_help %s_help[] = {", name);
+    for(i = 0; i < sizeof(_static_help_widths) / sizeof(*_static_help_widths); ++i)
+    {
+        for(narrow = 1; narrow >= 0; --narrow)
+        {
+            if(!narrow && _static_help_widths[i] < 100) /* always narrow */
+            {
+                continue;
+            }
+            print_sink_init_buffer(&sink);
+            print_sink_set_allocator(&sink, options->allocator.reallocate, options->allocator.deallocate, options->allocator.context);
+            _render_help(options, &sink, _static_help_widths[i], narrow);
+            if(!sink.valid)
+            {
+                print_sink_release(&sink);
+                return 0;
+            }
+            printf("%s\n    { %u, %d,", *nhelp ? "," : "", _static_help_widths[i], narrow);
+            _print_c_text(sink.data, sink.size, "        ");
+            printf(",\n        %lu }", (unsigned long)sink.size);
+            print_sink_release(&sink);
+            *nhelp += 1;
+        }
+    }
+    printf("\n};\n\n");
+    print_sink_init_buffer(&sink);
+    print_sink_set_allocator(&sink, options->allocator.reallocate, options->allocator.deallocate, options->allocator.context);
+    cmdoptions_export_manpage_sink(options, &sink);
+    if(!sink.valid)
+    {
+        print_sink_release(&sink);
+        return 0;
+    }
+    printf("static const char %s_manpage[] =", name);
+    if(sink.size)
+    {
+        _print_c_text(sink.data, sink.size, "    ");
+    }
+    else
+    {
+        printf(" \"\"");
+    }
+    printf(";\n\n");
+    print_sink_release(&sink);
+    return 1;
+}
+
+/* prints C source with a struct cmdoptions_static_table '<name>_table' for cmdoptions_create_static */
+int cmdoptions_export_static_table(const struct cmdoptions* options, const char* name)
+{
+    const struct cmdoptions_allocator* allocator = &options->allocator;
+    unsigned int m;
+    size_t first_entry = 0;
+    size_t nmodes = options->size - 1;
+    const char** keys = allocator->allocate(allocator->context, options->size * sizeof(*keys));
+    int* values = allocator->allocate(allocator->context, options->size * sizeof(*values));
+    unsigned long* seeds = allocator->allocate(allocator->context, (nmodes / 2 + 1) * sizeof(*seeds));
+    int* slots = allocator->allocate(allocator->context, (nmodes + nmodes / 4 + 1) * sizeof(*slots));
+    size_t* nkeys = allocator->allocate(allocator->context, options->size * sizeof(*nkeys));
+    size_t nhelp;
+    int ret = 0;
+    if(!keys || !values || !seeds || !slots || !nkeys)
+    {
+        goto CLEANUP;
+    }
+    printf("/* generated by cmdoptions_export_static_table, do not edit */\n");
+    printf("#include \"cmdoptions.h\"\n\n");
+    for(m = 0; m < options->size; ++m)
+    {
+        if(!_export_static_mode(options, options->modes[m], name, m, &nkeys[m]))
+        {
+            goto CLEANUP;
+        }
+        if(m > 0)
+        {
+            keys[m - 1] = options->modes[m]->identifier;
+            values[m - 1] = m;
+        }
+        putchar('\n');
+    }
+    if(!_build_perfect_hash(allocator, keys, values, nmodes, seeds, slots))
+    {
+        goto CLEANUP;
+    }
+    _print_hash(name, "mode", 0, seeds, slots, nmodes);
+    printf("\nstatic const struct cmdoptions_static_mode %s_modes[] = {\n", name);
+    for(m = 0; m < options->size; ++m)
+    {
+        const struct mode* mode = options->modes[m];
+        fputs("    { ", stdout);
+        _print_c_string(mode->identifier);
+        if(mode->entries_size)
+        {
+            printf(", %s_entries_%u", name, m);
+        }
+        else
+        {
+            printf(", NULL");
+        }
+        printf(", %lu, %lu, %s_short_%u, { %s_long_seeds_%u, %lu, %s_long_slots_%u, %lu } }%s\n",
+            (unsigned long)mode->entries_size, (unsigned long)first_entry, name, m,
+            name, m, (unsigned long)(nkeys[m] / 2 + 1), name, m, (unsigned long)(nkeys[m] + nkeys[m] / 4 + 1),
+            m + 1 < options->size ? "," : "");
+        first_entry += mode->entries_size;
+    }
+    printf("};\n\n");
+    if(!_export_static_help(options, name, &nhelp))
+    {
+        goto CLEANUP;
+    }
+    printf("const struct cmdoptions_static_table %s_table = {\n", name);
+    printf("    %s_modes, %lu, { %s_mode_seeds_0, %lu, %s_mode_slots_0, %lu }, %lu,\n    ",
+        name, (unsigned long)options->size, name, (unsigned long)(nmodes / 2 + 1), name, (unsigned long)(nmodes + nmodes / 4 + 1), (unsigned long)first_entry);
+    _print_c_string(options->prehelpmsg);
+    fputs(",\n    ", stdout);
+    _print_c_string(options->posthelpmsg);
+    printf(",\n    %s_help, %lu, %s_manpage\n};\n", name, (unsigned long)nhelp, name);
+    ret = 1;
+CLEANUP:
+    allocator->deallocate(allocator->context, keys);
+    allocator->deallocate(allocator->context, values);
+    allocator->deallocate(allocator->context, seeds);
+    allocator->deallocate(allocator->context, slots);
+    allocator->deallocate(allocator->context, nkeys);
+    return ret;
+}
+
+static void _print_id_part(const char* str)
+{
+    while(*str)
+    {
+        putchar(isalnum((unsigned char)*str) ? toupper((unsigned char)*str) : '_');
+        ++str;
+    }
+}
+
+/* an earlier option has the same identifier, so the ID would be defined twice */
+static int _shadowed(const struct mode* mode, size_t index)
+{
+    size_t i;
+    const struct option* option = mode->entries[index]->value;
+    const struct option* other;
+    for(i = 0; i < index; ++i)
+    {
+        other = mode->entries[i]->value;
+        if(mode->entries[i]->what != OPTION)
+        {
+            continue;
+        }
+        if(option->long_identifier ? other->long_identifier && strcmp(other->long_identifier, option->long_identifier) == 0 : !other->long_identifier && other->short_identifier == option->short_identifier)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* prints a header with the option IDs ('<NAME>_<MODE>_<LONG IDENTIFIER>') and the declaration of the table */
+int cmdoptions_export_static_header(const struct cmdoptions* options, const char* name)
+{
+    unsigned int m;
+    size_t i;
+    size_t id = 0;
+    printf("/* generated by cmdoptions_export_static_header, do not edit */\n");
+    fputs("#ifndef ", stdout);
+    _print_id_part(name);
+    printf("_TABLE_H\n#define ");
+    _print_id_part(name);
+    printf("_TABLE_H\n\n#include \"cmdoptions.h\"\n\n");
+    printf("/* option IDs for cmdoptions_was_provided_id and cmdoptions_get_argument_id */\n");
+    printf("enum %s_option {\n", name);
+    for(m = 0; m < options->size; ++m)
+    {
+        const struct mode* mode = options->modes[m];
+        for(i = 0; i < mode->entries_size; ++i, ++id)
+        {
+            const struct option* option = mode->entries[i]->value;
+            if(mode->entries[i]->what != OPTION || option->aliased || _shadowed(mode, i))
+            {
+                continue;
+            }
+            fputs("    ", stdout);
+            _print_id_part(name);
+            putchar('_');
+            if(mode->identifier)
+            {
+                _print_id_part(mode->identifier);
+                putchar('_');
+            }
+            if(option->long_identifier)
+            {
+                _print_id_part(option->long_identifier);
+            }
+            else if(isalnum((unsigned char)option->short_identifier))
+            {
+                printf("SHORT_%c", option->short_identifier);
+            }
+            else
+            {
+                printf("SHORT_%d", (unsigned char)option->short_identifier);
+            }
+            printf(" = %lu,\n", (unsigned long)id);
+        }
+    }
+    fputs("    ", stdout);
+    _print_id_part(name);
+    printf("_NUMBER_OF_IDS = %lu\n};\n\n", (unsigned long)id);
+    printf("extern const struct cmdoptions_static_table %s_table;\n\n#endif\n", name);
+    return 1;
+}
+
+/*
+ * snapshots: the same tables as cmdoptions_export_static_table generates, but as a binary blob
+ * references are offsets from the start of the blob (0 is NULL), so the blob can be mapped anywhere
+ * the blob is only valid for the machine (type sizes, byte order) that created it
+ */
+#define SNAPSHOT_MAGIC "cmdopts"
+#define SNAPSHOT_VERSION 1UL
+#define SNAPSHOT_CHECK 0x01020304UL
+
+struct snapshot_header {
+    char magic[8];
+    unsigned long version;
+    unsigned long check; /* byte order */
+    size_t type_sizes; /* sizeof(size_t), sizeof(unsigned long) and sizeof(int) */
+    size_t size; /* of the whole blob */
+    size_t modes;
+    size_t nmodes;
+    size_t mode_seeds;
+    size_t mode_slots;
+    size_t nmodekeys;
+    size_t entries; /* of all modes */
+    size_t prehelpmsg;
+    size_t posthelpmsg;
+};
+
+struct snapshot_mode {
+    size_t identifier;
+    size_t entries;
+    size_t size;
+    size_t short_table;
+    size_t seeds;
+    size_t slots;
+    size_t nkeys;
+};
+
+struct snapshot_entry {
+    int what;
+    int short_identifier;
+    int numargs;
+    int aliased;
+    int checked;
+    size_t long_identifier;
+    size_t default_argument;
+    size_t help;
+};
+
+struct snapshot_buffer {
+    char* data;
+    size_t size;
+    size_t capacity;
+    const struct cmdoptions_allocator* allocator;
+    int valid;
+};
+
+static size_t _snapshot_type_sizes(void)
+{
+    return sizeof(size_t) * 10000 + sizeof(unsigned long) * 100 + sizeof(int);
+}
+
+/* appends data (or zeros if data is NULL) at an aligned offset, returns the offset */
+static size_t _snapshot_put(struct snapshot_buffer* buffer, const void* data, size_t size)
+{
+    size_t offset = _align(buffer->size);
+    size_t capacity = buffer->capacity;
+    char* new;
+    if(!buffer->valid)
+    {
+        return 0;
+    }
+    while(offset + size > capacity)
+    {
+        capacity = capacity ? 2 * capacity : 4096;
+    }
+    if(capacity != buffer->capacity)
+    {
+        new = buffer->allocator->reallocate(buffer->allocator->context, buffer->data, capacity);
+        if(!new)
+        {
+            buffer->valid = 0;
+            return 0;
+        }
+        buffer->data = new;
+        buffer->capacity = capacity;
+    }
+    memset(buffer->data + buffer->size, 0, offset - buffer->size);
+    if(data)
+    {
+        memcpy(buffer->data + offset, data, size);
+    }
+    else
+    {
+        memset(buffer->data + offset, 0, size);
+    }
+    buffer->size = offset + size;
+    return offset;
+}
+
+static size_t _snapshot_put_string(struct snapshot_buffer* buffer, const char* str)
+{
+    return str ? _snapshot_put(buffer, str, strlen(str) + 1) : 0;
+}
+
+static int _snapshot_put_mode(struct snapshot_buffer* buffer, const struct cmdoptions* options, const struct mode* mode, size_t offset)
+{
+    size_t i;
+    struct snapshot_mode smode;
+    struct snapshot_entry sentry;
+    struct mode_tables tables;
+    if(!_build_mode_tables(buffer->allocator, mode, &tables))
+    {
+        return 0;
+    }
+    memset(&smode, 0, sizeof(smode)); /* no uninitialized padding in the file */
+    memset(&sentry, 0, sizeof(sentry));
+    smode.identifier = _snapshot_put_string(buffer, mode->identifier);
+    smode.entries = _snapshot_put(buffer, NULL, mode->entries_size * sizeof(sentry));
+    smode.size = mode->entries_size;
+    smode.short_table = _snapshot_put(buffer, tables.short_table, sizeof(tables.short_table));
+    smode.seeds = _snapshot_put(buffer, tables.seeds, (tables.nkeys / 2 + 1) * sizeof(*tables.seeds));
+    smode.slots = _snapshot_put(buffer, tables.slots, (tables.nkeys + tables.nkeys / 4 + 1) * sizeof(*tables.slots));
+    smode.nkeys = tables.nkeys;
+    _free_mode_tables(buffer->allocator, &tables);
+    for(i = 0; i < mode->entries_size; ++i)
+    {
+        if(mode->entries[i]->what == OPTION)
+        {
+            const struct option* option = mode->entries[i]->value;
+            sentry.what = CMDOPTIONS_STATIC_OPTION;
+            sentry.short_identifier = option->short_identifier;
+            sentry.numargs = option->numargs;
+            sentry.aliased = option->aliased ? _entry_index(mode, option->aliased) : -1;
+            sentry.checked = _was_checked(options, option);
+            sentry.long_identifier = _snapshot_put_string(buffer, option->long_identifier);
+            sentry.default_argument = _snapshot_put_string(buffer, _single_default(option));
+            sentry.help = _snapshot_put_string(buffer, option->help);
+        }
+        else /* section */
+        {
+            sentry.what = CMDOPTIONS_STATIC_SECTION;
+            sentry.short_identifier = 0;
+            sentry.numargs = 0;
+            sentry.aliased = -1;
+            sentry.checked = 0;
+            sentry.long_identifier = _snapshot_put_string(buffer, ((const struct section*)mode->entries[i]->value)->name);
+            sentry.default_argument = 0;
+            sentry.help = 0;
+        }
+        if(buffer->valid) /* the buffer might have moved */
+        {
+            memcpy(buffer->data + smode.entries + i * sizeof(sentry), &sentry, sizeof(sentry));
+        }
+    }
+    if(buffer->valid)
+    {
+        memcpy(buffer->data + offset, &smode, sizeof(smode));
+    }
+    return buffer->valid;
+}
+
+int cmdoptions_save_snapshot(const struct cmdoptions* options, const char* path)
+{
+    struct snapshot_buffer buffer;
+    struct snapshot_header header;
+    struct mode_tables tables; /* of the mode names, the keys/values of the mode tables are reused */
+    unsigned int m;
+    size_t nmodes = options->size - 1;
+    FILE* file;
+    int ret = 0;
+    buffer.data = NULL;
+    buffer.size = 0;
+    buffer.capacity = 0;
+    buffer.allocator = &options->allocator;
+    buffer.valid = 1;
+    tables.keys = buffer.allocator->allocate(buffer.allocator->context, options->size * sizeof(*tables.keys));
+    tables.values = buffer.allocator->allocate(buffer.allocator->context, options->size * sizeof(*tables.values));
+    tables.seeds = buffer.allocator->allocate(buffer.allocator->context, (nmodes / 2 + 1) * sizeof(*tables.seeds));
+    tables.slots = buffer.allocator->allocate(buffer.allocator->context, (nmodes + nmodes / 4 + 1) * sizeof(*tables.slots));
+    if(!tables.keys || !tables.values || !tables.seeds || !tables.slots)
+    {
+        goto CLEANUP;
+    }
+    for(m = 1; m < options->size; ++m)
+    {
+        tables.keys[m - 1] = options->modes[m]->identifier;
+        tables.values[m - 1] = m;
+    }
+    if(!_build_perfect_hash(buffer.allocator, tables.keys, tables.values, nmodes, tables.seeds, tables.slots))
+    {
+        goto CLEANUP;
+    }
+    memset(&header, 0, sizeof(header));
+    strcpy(header.magic, SNAPSHOT_MAGIC);
+    header.version = SNAPSHOT_VERSION;
+    header.check = SNAPSHOT_CHECK;
+    header.type_sizes = _snapshot_type_sizes();
+    _snapshot_put(&buffer, NULL, sizeof(header)); /* written at the end */
+    header.nmodes = options->size;
+    header.modes = _snapshot_put(&buffer, NULL, options->size * sizeof(struct snapshot_mode));
+    header.mode_seeds = _snapshot_put(&buffer, tables.seeds, (nmodes / 2 + 1) * sizeof(*tables.seeds));
+    header.mode_slots = _snapshot_put(&buffer, tables.slots, (nmodes + nmodes / 4 + 1) * sizeof(*tables.slots));
+    header.nmodekeys = nmodes;
+    header.entries = 0;
+    for(m = 0; m < options->size; ++m)
+    {
+        if(!_snapshot_put_mode(&buffer, options, options->modes[m], header.modes + m * sizeof(struct snapshot_mode)))
+        {
+            goto CLEANUP;
+        }
+        header.entries += options->modes[m]->entries_size;
+    }
+    header.prehelpmsg = _snapshot_put_string(&buffer, options->prehelpmsg);
+    header.posthelpmsg = _snapshot_put_string(&buffer, options->posthelpmsg);
+    _snapshot_put(&buffer, "", 1); /* the blob ends with 0, so every string in it is terminated */
+    if(!buffer.valid)
+    {
+        goto CLEANUP;
+    }
+    header.size = buffer.size;
+    memcpy(buffer.data, &header, sizeof(header));
+    file = fopen(path, "wb");
+    if(!file)
+    {
+        goto CLEANUP;
+    }
+    ret = fwrite(buffer.data, 1, buffer.size, file) == buffer.size;
+    ret = fclose(file) == 0 && ret;
+CLEANUP:
+    _free_mode_tables(buffer.allocator, &tables);
+    buffer.allocator->deallocate(buffer.allocator->context, buffer.data);
+    return ret;
+}
+
+static void _release_snapshot(char* snapshot, size_t size, int mapped, struct cmdoptions_static_table* table)
+{
+#ifdef CMDOPTIONS_ENABLE_MMAP
+    if(mapped)
+    {
+        munmap(snapshot, size);
+    }
+#else
+    (void)size;
+#endif
+    if(!mapped)
+    {
+        _default_allocator.deallocate(_default_allocator.context, snapshot);
+    }
+    _default_allocator.deallocate(_default_allocator.context, table);
+}
+
+static char* _read_snapshot(const char* path, size_t* size, int* mapped)
+{
+#ifdef CMDOPTIONS_ENABLE_MMAP
+    struct stat st;
+    char* data;
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        return NULL;
+    }
+    if(fstat(fd, &st) < 0 || st.st_size == 0)
+    {
+        close(fd);
+        return NULL;
+    }
+    *size = st.st_size;
+    data = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED)
+    {
+        return NULL;
+    }
+    *mapped = 1;
+    return data;
+#else
+    long length;
+    char* data;
+    FILE* file = fopen(path, "rb");
+    if(!file)
+    {
+        return NULL;
+    }
+    if(fseek(file, 0, SEEK_END) != 0 || (length = ftell(file)) <= 0 || fseek(file, 0, SEEK_SET) != 0)
+    {
+        fclose(file);
+        return NULL;
+    }
+    *size = length;
+    /* allocated memory is aligned for everything in the blob */
+    data = _default_allocator.allocate(_default_allocator.context, *size);
+    if(!data || fread(data, 1, *size, file) != *size)
+    {
+        _default_allocator.deallocate(_default_allocator.context, data);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+    *mapped = 0;
+    return data;
+#endif
+}
+
+/* an array in the blob, offset 0 is only allowed for count 0 */
+static int _snapshot_range(size_t size, size_t offset, size_t count, size_t element)
+{
+    if(offset % sizeof(union _max_align) != 0 || offset > size || (count && !offset))
+    {
+        return 0;
+    }
+    return count <= (size - offset) / element;
+}
+
+/* indices are -1 or below limit, if entries are given, they must refer to options */
+static int _snapshot_indices(const int* indices, size_t count, size_t limit, const struct cmdoptions_static_entry* entries)
+{
+    size_t i;
+    for(i = 0; i < count; ++i)
+    {
+        if(indices[i] < -1 || indices[i] >= (int)limit || (entries && indices[i] >= 0 && entries[indices[i]].what != CMDOPTIONS_STATIC_OPTION))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* builds the table (one allocation), the strings and lookup tables stay in the blob */
+static struct cmdoptions_static_table* _snapshot_table(const char* blob, size_t size)
+{
+    struct snapshot_header header;
+    const struct snapshot_mode* smodes;
+    const struct snapshot_entry* sentries;
+    struct cmdoptions_static_table* table;
+    struct cmdoptions_static_mode* modes;
+    struct cmdoptions_static_entry* entries;
+    size_t m;
+    size_t i;
+    size_t first_entry = 0;
+    if(size < sizeof(header) || blob[size - 1] != 0)
+    {
+        return NULL;
+    }
+    memcpy(&header, blob, sizeof(header));
+    if(memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || header.version != SNAPSHOT_VERSION || header.check != SNAPSHOT_CHECK ||
+        header.type_sizes != _snapshot_type_sizes() || header.size != size || header.nmodes == 0 ||
+        !_snapshot_range(size, header.modes, header.nmodes, sizeof(*smodes)) ||
+        !_snapshot_range(size, header.mode_seeds, header.nmodekeys / 2 + 1, sizeof(unsigned long)) ||
+        !_snapshot_range(size, header.mode_slots, header.nmodekeys + header.nmodekeys / 4 + 1, sizeof(int)) ||
+        !_snapshot_indices((const int*)(blob + header.mode_slots), header.nmodekeys + header.nmodekeys / 4 + 1, header.nmodes, NULL) ||
+        header.prehelpmsg >= size || header.posthelpmsg >= size || !header.prehelpmsg || !header.posthelpmsg ||
+        header.entries > size / sizeof(*sentries))
+    {
+        return NULL;
+    }
+    table = _default_allocator.allocate(_default_allocator.context, sizeof(*table) + header.nmodes * sizeof(*modes) + header.entries * sizeof(*entries));
+    if(!table)
+    {
+        return NULL;
+    }
+    modes = (struct cmdoptions_static_mode*)(table + 1);
+    entries = (struct cmdoptions_static_entry*)(modes + header.nmodes);
+    smodes = (const struct snapshot_mode*)(blob + header.modes);
+    for(m = 0; m < header.nmodes; ++m)
+    {
+        if(!_snapshot_range(size, smodes[m].entries, smodes[m].size, sizeof(*sentries)) || smodes[m].size > header.entries - first_entry ||
+            smodes[m].identifier >= size || (m > 0) != (smodes[m].identifier != 0) ||
+            !_snapshot_range(size, smodes[m].short_table, 256, sizeof(int)) ||
+            !_snapshot_range(size, smodes[m].seeds, smodes[m].nkeys / 2 + 1, sizeof(unsigned long)) ||
+            !_snapshot_range(size, smodes[m].slots, smodes[m].nkeys + smodes[m].nkeys / 4 + 1, sizeof(int)))
+        {
+            _default_allocator.deallocate(_default_allocator.context, table);
+            return NULL;
+        }
+        modes[m].identifier = smodes[m].identifier ? blob + smodes[m].identifier : NULL;
+        modes[m].entries = entries + first_entry;
+        modes[m].size = smodes[m].size;
+        modes[m].first_entry = first_entry;
+        modes[m].short_table = (const int*)(blob + smodes[m].short_table);
+        modes[m].long_hash.seeds = (const unsigned long*)(blob + smodes[m].seeds);
+        modes[m].long_hash.seeds_size = smodes[m].nkeys / 2 + 1;
+        modes[m].long_hash.slots = (const int*)(blob + smodes[m].slots);
+        modes[m].long_hash.slots_size = smodes[m].nkeys + smodes[m].nkeys / 4 + 1;
+        sentries = (const struct snapshot_entry*)(blob + smodes[m].entries);
+        for(i = 0; i < smodes[m].size; ++i)
+        {
+            if(sentries[i].long_identifier >= size || sentries[i].default_argument >= size || sentries[i].help >= size || (sentries[i].numargs & ARG_TYPE_MASK) > DURATION_ARG ||
+                (sentries[i].what != CMDOPTIONS_STATIC_OPTION && (sentries[i].what != CMDOPTIONS_STATIC_SECTION || !sentries[i].long_identifier)))
+            {
+                _default_allocator.deallocate(_default_allocator.context, table);
+                return NULL;
+            }
+            entries[first_entry + i].what = sentries[i].what;
+            entries[first_entry + i].short_identifier = sentries[i].short_identifier;
+            entries[first_entry + i].long_identifier = sentries[i].long_identifier ? blob + sentries[i].long_identifier : NULL;
+            entries[first_entry + i].numargs = sentries[i].numargs;
+            entries[first_entry + i].default_argument = sentries[i].default_argument ? blob + sentries[i].default_argument : NULL;
+            entries[first_entry + i].help = sentries[i].help ? blob + sentries[i].help : NULL;
+            entries[first_entry + i].aliased = sentries[i].aliased;
+            entries[first_entry + i].checked = sentries[i].checked;
+        }
+        for(i = 0; i < smodes[m].size; ++i)
+        {
+            if(!_snapshot_indices(&entries[first_entry + i].aliased, 1, smodes[m].size, entries + first_entry))
+            {
+                _default_allocator.deallocate(_default_allocator.context, table);
+                return NULL;
+            }
+        }
+        if(!_snapshot_indices(modes[m].short_table, 256, smodes[m].size, entries + first_entry) ||
+            !_snapshot_indices(modes[m].long_hash.slots, modes[m].long_hash.slots_size, smodes[m].size, entries + first_entry))
+        {
+            _default_allocator.deallocate(_default_allocator.context, table);
+            return NULL;
+        }
+        first_entry += smodes[m].size;
+    }
+    table->modes = modes;
+    table->size = header.nmodes;
+    table->mode_hash.seeds = (const unsigned long*)(blob + header.mode_seeds);
+    table->mode_hash.seeds_size = header.nmodekeys / 2 + 1;
+    table->mode_hash.slots = (const int*)(blob + header.mode_slots);
+    table->mode_hash.slots_size = header.nmodekeys + header.nmodekeys / 4 + 1;
+    table->entries = first_entry;
+    table->prehelpmsg = blob + header.prehelpmsg;
+    table->posthelpmsg = blob + header.posthelpmsg;
+    table->help = NULL;
+    table->help_size = 0;
+    table->manpage = NULL;
+    return table;
+}
+
+struct cmdoptions* cmdoptions_load_snapshot(const char* path)
+{
+    struct cmdoptions* options;
+    struct cmdoptions_static_table* table;
+    size_t size;
+    int mapped;
+    char* snapshot = _read_snapshot(path, &size, &mapped);
+    if(!snapshot)
+    {
+        return NULL;
+    }
+    table = _snapshot_table(snapshot, size);
+    if(!table)
+    {
+        _release_snapshot(snapshot, size, mapped, NULL);
+        return NULL;
+    }
+    options = cmdoptions_create_static(table);
+    if(!options)
+    {
+        _release_snapshot(snapshot, size, mapped, table);
+        return NULL;
+    }
+    options->snapshot_table = table;
+    options->snapshot = snapshot;
+    options->snapshot_size = size;
+    options->snapshot_mapped = mapped;
+    return options;
+}
+
+const char** cmdoptions_result_get_positional_parameters(const struct cmdoptions_result* result)
+{
+    return (const char**) result->positional_parameters;
+}
+
+const char** cmdoptions_get_positional_parameters(const struct cmdoptions* options)
+{
+    return cmdoptions_result_get_positional_parameters(options->result);
+}
+
+size_t cmdoptions_result_get_positional_count(const struct cmdoptions_result* result)
+{
+    return result->positional_parameters_size;
+}
+
+size_t cmdoptions_get_positional_count(const struct cmdoptions* options)
+{
+    return cmdoptions_result_get_positional_count(options->result);
+}
+
+const char* cmdoptions_result_get_positional_parameter(const struct cmdoptions_result* result, size_t index)
+{
+    if(index >= result->positional_parameters_size)
+    {
+        return NULL;
+    }
+    return result->positional_parameters[index];
+}
+
+const char* cmdoptions_get_positional_parameter(const struct cmdoptions* options, size_t index)
+{
+    return cmdoptions_result_get_positional_parameter(options->result, index);
+}
+
+static int _no_positional_parameters(const struct cmdoptions* options)
+{
+    return options->result->positional_parameters_size == 0;
+}
+
+static int _add_positional_parameter(struct cmdoptions_result* result, const char* arg)
+{
+    char** positional_parameters;
+    char* value;
+    size_t capacity;
+    if(result->positional_parameters_size == 0)
+    {
+        result->positional_parameters_borrowed = result->options->borrow_arguments;
+    }
+    value = result->positional_parameters_borrowed ? (char*)arg : _result_copy_string(result, arg);
+    if(!value)
+    {
+        return 0;
+    }
+    if(result->positional_parameters_size + 2 > result->positional_parameters_capacity) /* +2: new entry and sentinel */
+    {
+        capacity = 2 * result->positional_parameters_capacity;
+        if(capacity < 8)
+        {
+            capacity = 8;
+        }
+        positional_parameters = _result_realloc(result,
+            result->positional_parameters,
+            sizeof(*result->positional_parameters) * result->positional_parameters_capacity,
+            sizeof(*result->positional_parameters) * capacity);
+        if(!positional_parameters)
+        {
+            if(!result->positional_parameters_borrowed)
+            {
+                _result_free(result, value);
+            }
+            return 0;
+        }
+        result->positional_parameters = positional_parameters;
+        result->positional_parameters_capacity = capacity;
+    }
+    result->positional_parameters[result->positional_parameters_size] = value;
+    result->positional_parameters_size += 1;
+    result->positional_parameters[result->positional_parameters_size] = NULL; /* terminate */
+    return 1;
+}
+
+int cmdoptions_result_help_passed(const struct cmdoptions_result* result)
+{
+    return result->help_passed;
+}
+
+int cmdoptions_help_passed(struct cmdoptions* options)
+{
+    return cmdoptions_result_help_passed(options->result);
+}
+
+int cmdoptions_empty(const struct cmdoptions* options)
+{
+    return cmdoptions_no_args_given(options) && _no_positional_parameters(options);
+}
+
+static int _no_args_given(const struct cmdoptions_result* result, const struct mode* mode)
+{
+    unsigned int i;
+    for(i = 0; i < mode->entries_size; ++i)
+    {
+        const struct entry* entry = mode->entries[i];
+        if(entry->what == OPTION)
+        {
+            const struct option* option = entry->value;
+            if(_state(result, option)->was_provided)
+            {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+int cmdoptions_result_no_args_given(const struct cmdoptions_result* result)
+{
+    unsigned int m;
+    int ret = 1;
+    for(m = 0; m < result->options->size; ++m)
+    {
+        const struct mode* mode = result->options->modes[m];
+        if(result->modes[mode->id].was_selected)
+        {
+            ret = ret && _no_args_given(result, mode);
+        }
+    }
+    return ret;
+}
+
+int cmdoptions_no_args_given(const struct cmdoptions* options)
+{
+    return cmdoptions_result_no_args_given(options->result);
+}
+
+int cmdoptions_result_mode_no_args_given(const struct cmdoptions_result* result, const char* modename)
+{
+    const struct mode* mode = _find_const_mode(result, modename);
+    if(!mode)
+    {
+        fprintf(stderr, "trying to access command-line mode '%s'. This mode does not exist\n", modename);
+        return -1;
+    }
+    return _no_args_given(result, mode);
+}
+
+int cmdoptions_mode_no_args_given(const struct cmdoptions* options, const char* modename)
+{
+    return cmdoptions_result_mode_no_args_given(options->result, modename);
+}
+
+/* querying marks the option as checked, see cmdoptions_assert_all_options_checked */
+static int _was_provided(struct cmdoptions_result* result, const struct option* option)
+{
+    struct option_state* state;
+    if(option)
+    {
+        state = _state(result, option);
+        state->was_checked = 1;
+        return state->was_provided;
+    }
+    return 0;
+}
+
+int cmdoptions_result_was_provided_short(struct cmdoptions_result* result, char short_identifier)
+{
+    const struct mode* mode = _get_const_basemode(result->options);
+    return _was_provided(result, _get_const_option(result, mode, short_identifier, NULL));
+}
+
+int cmdoptions_was_provided_short(struct cmdoptions* options, char short_identifier)
+{
+    return cmdoptions_result_was_provided_short(options->result, short_identifier);
+}
+
+int cmdoptions_result_mode_was_provided_short(struct cmdoptions_result* result, const char* modename, char short_identifier)
+{
+    const struct mode* mode = _find_const_mode(result, modename);
+    if(!mode)
+    {
+        fprintf(stderr, "trying to access command-line option '%c' of mode '%s'. This mode does not exist\n", short_identifier, modename);
+        return 0;
+    }
+    return _was_provided(result, _get_const_option(result, mode, short_identifier, NULL));
+}
+
+int cmdoptions_mode_was_provided_short(struct cmdoptions* options, const char* modename, char short_identifier)
+{
+    return cmdoptions_result_mode_was_provided_short(options->result, modename, short_identifier);
+}
+
+int cmdoptions_result_was_provided_long(struct cmdoptions_result* result, const char* long_identifier)
+{
+    const struct mode* mode = _get_const_basemode(result->options);
+    return _was_provided(result, _get_const_option(result, mode, 0, long_identifier));
+}
+
+int cmdoptions_was_provided_long(struct cmdoptions* options, const char* long_identifier)
+{
+    return cmdoptions_result_was_provided_long(options->result, long_identifier);
+}
+
+int cmdoptions_result_mode_was_provided_long(struct cmdoptions_result* result, const char* modename, const char* long_identifier)
+{
+    const struct mode* mode = _find_const_mode(result, modename);
+    if(!mode)
+    {
+        fprintf(stderr, "trying to access command-line option '%s' of mode '%s'. This mode does not exist\n", long_identifier, modename);
+        return 0;
+    }
+    return _was_provided(result, _get_const_option(result, mode, 0, long_identifier));
+}
+
+int cmdoptions_mode_was_provided_long(struct cmdoptions* options, const char* modename, const char* long_identifier)
+{
+    return cmdoptions_result_mode_was_provided_long(options->result, modename, long_identifier);
+}
+
+/* option IDs of static tables */
+static const struct option* _get_option_id(const struct cmdoptions* options, int id)
+{
+    const struct option* option;
+    if(!options->table || id < 0 || (size_t)id >= options->table->entries || options->static_entries[id].what != OPTION)
+    {
+        return NULL;
+    }
+    option = options->static_entries[id].value;
+    return option->aliased ? option->aliased : option;
+}
+
+int cmdoptions_result_was_provided_id(struct cmdoptions_result* result, int id)
+{
+    return _was_provided(result, _get_option_id(result->options, id));
+}
+
+int cmdoptions_was_provided_id(struct cmdoptions* options, int id)
+{
+    return cmdoptions_result_was_provided_id(options->result, id);
+}
+
+/* response files: '@path' on the command line is replaced by the words in the file */
+#define RESPONSE_FILE_DEPTH 16
+
+struct token_source {
+    const char* const* argv; /* used if cursor is NULL */
+    int argc;
+    int index;
+    struct response_file* file; /* NULL for argv and strings */
+    char* cursor; /* words of a response file or string, split in place */
+    char* end;
+};
+
+struct token_stream {
+    struct token_source sources[RESPONSE_FILE_DEPTH + 1]; /* first source is argv */
+    int depth;
+    int expand;
+    int endofoptions; /* no expansion after '--' */
+    int (*callback)(const struct cmdoptions_event* event, void* userdata); /* NULL: results are stored in the structure */
+    void* userdata;
+    const char* modename; /* selected mode, reported with events */
+    struct response_file* popped; /* finished files, released once the current token is handled (it may point into them) */
+};
+
+static int _read_response_file(struct cmdoptions_result* result, const char* path, struct response_file* file)
+{
+#ifdef CMDOPTIONS_ENABLE_MMAP
+    struct stat st;
+    char* data;
+    int fd = open(path, O_RDONLY);
+    (void)result;
+    if(fd < 0)
+    {
+        return 0;
+    }
+    if(fstat(fd, &st) < 0)
+    {
+        close(fd);
+        return 0;
+    }
+    file->size = st.st_size;
+    /*
+     * reserve one byte more than the file size, so that the last word can be terminated in place
+     * the private mapping of the file is placed over the start of an anonymous mapping, which provides this byte even if the file ends on a page boundary
+     */
+    data = mmap(NULL, file->size + 1, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(data == MAP_FAILED)
+    {
+        close(fd);
+        return 0;
+    }
+    if(file->size > 0 && mmap(data, file->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+        munmap(data, file->size + 1);
+        close(fd);
+        return 0;
+    }
+    close(fd);
+    file->data = data;
+    file->mapped = 1;
+    return 1;
+#else
+    long size;
+    FILE* f = fopen(path, "rb");
+    if(!f)
+    {
+        return 0;
+    }
+    if(fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) < 0 || fseek(f, 0, SEEK_SET) != 0)
+    {
+        fclose(f);
+        return 0;
+    }
+    file->size = size;
+    file->data = _result_alloc(result, file->size + 1);
+    if(!file->data || fread(file->data, 1, file->size, f) != file->size)
+    {
+        _result_free(result, file->data);
+        fclose(f);
+        return 0;
+    }
+    fclose(f);
+    file->data[file->size] = 0;
+    file->mapped = 0;
+    return 1;
+#endif
+}
+
+static void _release_file_data(struct cmdoptions_result* result, struct response_file* file)
+{
+#ifdef CMDOPTIONS_ENABLE_MMAP
+    if(file->mapped)
+    {
+        munmap(file->data, file->size + 1);
+    }
+#endif
+    if(!file->mapped)
+    {
+        _result_free(result, file->data);
+    }
+}
+
+static void _release_response_file(struct cmdoptions_result* result, struct response_file* file)
+{
+    _release_file_data(result, file);
+    _result_free(result, file);
+}
+
+static int _is_space(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\v' || ch == '\f';
+}
+
+/*
+ * split the next word off a buffer in place, with shell-like quoting:
+ * 'single quotes' are literal, "double quotes" allow \" \\ \$ \` and line continuations, a backslash outside of quotes escapes any character
+ * the buffer must provide one writable byte at end
+ * returns 1 if a word was found, 0 at the end of the buffer and -1 for unterminated quotes
+ */
+static int _next_word(char** cursor, char* end, char** word)
+{
+    char* src = *cursor;
+    char* dest;
+    char quote = 0;
+    while(src < end && _is_space(*src))
+    {
+        ++src;
+    }
+    if(src >= end)
+    {
+        *cursor = src;
+        return 0;
+    }
+    *word = src;
+    dest = src;
+    while(src < end)
+    {
+        if(quote == '\'')
+        {
+            if(*src == '\'')
+            {
+                quote = 0;
+            }
+            else
+            {
+                *dest++ = *src;
+            }
+            ++src;
+        }
+        else if(quote == '"')
+        {
+            if(*src == '"')
+            {
+                quote = 0;
+                ++src;
+            }
+            else if(*src == '\\' && src + 1 < end && (src[1] == '"' || src[1] == '\\' || src[1] == '$' || src[1] == '`' || src[1] == '\n'))
+            {
+                if(src[1] != '\n')
+                {
+                    *dest++ = src[1];
+                }
+                src += 2;
+            }
+            else
+            {
+                *dest++ = *src++;
+            }
+        }
+        else if(_is_space(*src))
+        {
+            break;
+        }
+        else if(*src == '\'' || *src == '"')
+        {
+            quote = *src++;
+        }
+        else if(*src == '\\' && src + 1 < end)
+        {
+            if(src[1] != '\n') /* line continuation */
+            {
+                *dest++ = src[1];
+            }
+            src += 2;
+        }
+        else
+        {
+            *dest++ = *src++;
+        }
+    }
+    if(quote)
+    {
+        return -1;
+    }
+    /* the terminator overwrites at most the separator, which is skipped */
+    *cursor = src < end ? src + 1 : src;
+    *dest = 0;
+    return 1;
+}
+
+static void _open_stream(struct token_stream* stream, int argc, const char* const * argv, int expand)
+{
+    stream->sources[0].argv = argv;
+    stream->sources[0].argc = argc;
+    stream->sources[0].index = 1; /* skip program name */
+    stream->sources[0].file = NULL;
+    stream->sources[0].cursor = NULL;
+    stream->depth = 0;
+    stream->expand = expand;
+    stream->endofoptions = 0;
+    stream->callback = NULL;
+    stream->userdata = NULL;
+    stream->modename = NULL;
+    stream->popped = NULL;
+}
+
+/* the words of str are the command line (without program name) */
+static void _open_string_stream(struct token_stream* stream, char* str, int expand)
+{
+    _open_stream(stream, 0, NULL, expand);
+    stream->sources[0].cursor = str;
+    stream->sources[0].end = str + strlen(str); /* the terminator is the writable byte _next_word needs */
+}
+
+static void _init_event(struct cmdoptions_event* event, const struct token_stream* stream, int type)
+{
+    event->type = type;
+    event->modename = stream->modename;
+    event->short_identifier = 0;
+    event->long_identifier = NULL;
+    event->numargs = 0;
+    event->value = NULL;
+    event->typed_value = NULL;
+    event->error = NULL;
+}
+
+/* parse errors are either printed or passed to the event callback; always returns 0 */
+static int _parse_error(const struct token_stream* stream, const char* message, const char* token)
+{
+    struct cmdoptions_event event;
+    if(stream->callback)
+    {
+        _init_event(&event, stream, CMDOPTIONS_EVENT_ERROR);
+        event.value = token;
+        event.error = message;
+        stream->callback(&event, stream->userdata);
+    }
+    else if(token)
+    {
+        printf("%s '%s'\n", message, token);
+    }
+    else
+    {
+        printf("%s\n", message);
+    }
+    return 0;
+}
+
+static void _pop_source(struct cmdoptions_result* result, struct token_stream* stream)
+{
+    struct response_file* file = stream->sources[stream->depth].file;
+    stream->depth -= 1;
+    if(result->options->borrow_arguments && !stream->callback) /* arguments might point into the file */
+    {
+        file->next = result->response_files;
+        result->response_files = file;
+    }
+    else
+    {
+        file->next = stream->popped;
+        stream->popped = file;
+    }
+}
+
+static void _release_popped(struct cmdoptions_result* result, struct token_stream* stream)
+{
+    struct response_file* file;
+    while(stream->popped)
+    {
+        file = stream->popped;
+        stream->popped = file->next;
+        _release_response_file(result, file);
+    }
+}
+
+static void _close_stream(struct cmdoptions_result* result, struct token_stream* stream)
+{
+    while(stream->depth > 0)
+    {
+        _pop_source(result, stream);
+    }
+    _release_popped(result, stream);
+}
+
+static int _push_response_file(struct cmdoptions_result* result, struct token_stream* stream, const char* path)
+{
+    struct token_source* source;
+    struct response_file* file;
+    if(stream->depth == RESPONSE_FILE_DEPTH)
+    {
+        return _parse_error(stream, "response files are nested too deeply:", path);
+    }
+    file = _result_alloc(result, sizeof(*file));
+    if(!file)
+    {
+        return 0;
+    }
+    if(!_read_response_file(result, path, file))
+    {
+        _result_free(result, file);
+        return _parse_error(stream, "could not read response file", path);
+    }
+    stream->depth += 1;
+    source = &stream->sources[stream->depth];
+    source->file = file;
+    source->cursor = file->data;
+    source->end = file->data + file->size;
+    return 1;
+}
+
+/* returns 1 if a token was found, 0 at the end of the command line and -1 on errors */
+static int _next_token(struct cmdoptions_result* result, struct token_stream* stream, const char** token)
+{
+    struct token_source* source;
+    char* word;
+    int status;
+    while(1)
+    {
+        source = &stream->sources[stream->depth];
+        if(source->cursor)
+        {
+            status = _next_word(&source->cursor, source->end, &word);
+            if(status < 0)
+            {
+                _parse_error(stream, source->file ? "unterminated quote in response file" : "unterminated quote", NULL);
+                return -1;
+            }
+            if(status == 0)
+            {
+                if(!source->file)
+                {
+                    return 0;
+                }
+                _pop_source(result, stream);
+                continue;
+            }
+            *token = word;
+        }
+        else
+        {
+            if(source->index >= source->argc)
+            {
+                return 0;
+            }
+            *token = source->argv[source->index];
+            source->index += 1;
+        }
+        /* nested response files are only opened once they are reached */
+        if(stream->expand && !stream->endofoptions && (*token)[0] == '@' && (*token)[1] != 0)
+        {
+            if(!_push_response_file(result, stream, *token + 1))
+            {
+                return -1;
+            }
+            continue;
+        }
+        return 1;
+    }
+}
+
+/* fetch the argument of an option from the stream */
+static int _next_argument(struct cmdoptions_result* result, struct token_stream* stream, const struct option* option, const char** arg)
+{
+    char identifier[2];
+    int status = _next_token(result, stream, arg);
+    if(status == 0) /* argument required, but no entries in argv left */
+    {
+        if(option->long_identifier)
+        {
+            return _parse_error(stream, "expected argument for option", option->long_identifier);
+        }
+        identifier[0] = option->short_identifier;
+        identifier[1] = 0;
+        return _parse_error(stream, "expected argument for option", identifier);
+    }
+    return status > 0;
+}
+
+/* typed arguments are converted once here, so the getters only return the values */
+static int _store_typed_argument(struct cmdoptions_result* result, const struct option* option, struct token_stream* stream, const char* arg)
+{
+    union typed_value value;
+    size_t size = _typed_size(option->numargs);
+    size_t capacity;
+    char* argument;
+    struct option_state* state = _state(result, option);
+    if(!_convert_argument(option->numargs, arg, &value))
+    {
+        return _parse_error(stream, _type_error(option->numargs), arg);
+    }
+    if(!(option->numargs & MULTI_ARGS))
+    {
+        state->value = value;
+        return 1;
+    }
+    /* the array of a previous command line is kept by a reset, no sentinel */
+    if(state->argument_size == state->argument_capacity)
+    {
+        capacity = 2 * state->argument_capacity;
+        if(capacity < 4)
+        {
+            capacity = 4;
+        }
+        argument = _result_realloc(result, state->argument, state->argument_capacity * size, capacity * size);
+        if(!argument)
+        {
+            return 0;
+        }
+        state->argument = argument;
+        state->argument_capacity = capacity;
+    }
+    _put_typed((char*)state->argument + state->argument_size * size, option->numargs, &value);
+    state->argument_size += 1;
+    state->argument_borrowed = 0;
+    return 1;
+}
+
+static int _store_argument(struct cmdoptions_result* result, const struct option* option, struct token_stream* stream)
+{
+    size_t capacity;
+    char** argument;
+    char* value;
+    const char* arg;
+    struct option_state* state = _state(result, option);
+    if(option->numargs)
     {
-        char* arg = malloc(strlen(default_arg) + 1);
-        if(!arg)
+        if(_next_argument(result, stream, option, &arg))
+        {
+            if(option->numargs & ARG_TYPE_MASK)
+            {
+                return _store_typed_argument(result, option, stream, arg);
+            }
+            else if(option->numargs & MULTI_ARGS)
+            {
+                if(!state->was_provided) /* start a new list, replacing the default argument */
+                {
+                    /* the (empty) array of a previous command line is kept by a reset */
+                    state->argument_borrowed = result->options->borrow_arguments;
+                }
+                value = state->argument_borrowed ? (char*)arg : _result_copy_string(result, arg);
+                if(!value)
+                {
+                    return 0;
+                }
+                if(state->argument_size + 2 > state->argument_capacity) /* +2: new entry and sentinel */
+                {
+                    capacity = 2 * state->argument_capacity;
+                    if(capacity < 4)
+                    {
+                        capacity = 4;
+                    }
+                    argument = _result_realloc(result, state->argument, state->argument_capacity * sizeof(*argument), capacity * sizeof(*argument));
+                    if(!argument)
+                    {
+                        if(!state->argument_borrowed)
+                        {
+                            _result_free(result, value);
+                        }
+                        return 0;
+                    }
+                    state->argument = argument;
+                    state->argument_capacity = capacity;
+                }
+                argument = state->argument;
+                argument[state->argument_size] = value;
+                state->argument_size += 1;
+                argument[state->argument_size] = NULL;
+            }
+            else /* SINGLE_ARG option */
+            {
+                value = result->options->borrow_arguments ? (char*)arg : _result_copy_string(result, arg);
+                if(!value)
+                {
+                    return 0;
+                }
+                /* repeated option */
+                _free_argument(result, option);
+                state->argument = value;
+                state->argument_borrowed = result->options->borrow_arguments;
+            }
+        }
+        else
         {
-            _destroy_entry(entry);
             return 0;
         }
-        strcpy(arg, default_arg);
-        ((struct option*)entry->value)->argument = arg;
     }
-    if(!_add_entry(basemode, entry))
+    return 1;
+}
+
+/* event-driven counterpart of _store_argument */
+static int _report_option(struct cmdoptions_result* result, const struct option* option, struct token_stream* stream)
+{
+    struct cmdoptions_event event;
+    union typed_value value;
+    _init_event(&event, stream, CMDOPTIONS_EVENT_OPTION);
+    event.short_identifier = option->short_identifier;
+    event.long_identifier = option->long_identifier;
+    event.numargs = option->numargs;
+    if(option->numargs && !_next_argument(result, stream, option, &event.value))
+    {
+        return 0;
+    }
+    if(option->numargs & ARG_TYPE_MASK)
+    {
+        if(!_convert_argument(option->numargs, event.value, &value))
+        {
+            return _parse_error(stream, _type_error(option->numargs), event.value);
+        }
+        event.typed_value = _typed_element(option->numargs, &value);
+    }
+    return stream->callback(&event, stream->userdata);
+}
+
+/* store or report an option, depending on the stream */
+static int _handle_option(struct cmdoptions_result* result, const struct option* option, struct token_stream* stream)
+{
+    struct option_state* state;
+    if(stream->callback)
+    {
+        return _report_option(result, option, stream);
+    }
+    if(!_store_argument(result, option, stream))
     {
-        _destroy_entry(entry);
         return 0;
     }
+    /* was_provided is checked in _store_argument, so this has to come after the _store_argument call */
+    state = _state(result, option);
+    if(!state->was_provided)
+    {
+        state->next_provided = result->provided;
+        result->provided = option;
+    }
+    state->was_provided = 1;
     return 1;
 }
 
-void cmdoptions_prepend_help_message(struct cmdoptions* options, const char* msg)
+static int _parse_stream(struct cmdoptions_result* result, struct token_stream* stream)
 {
-    int empty = options->prehelpmsg[0] == 0;
-    size_t len = strlen(options->prehelpmsg) + strlen(msg);
-    if(!empty)
+    int first = 1;
+    int status;
+    const char* arg;
+    char identifier[3];
+    struct cmdoptions_event event;
+    const struct cmdoptions* options = result->options;
+    const struct mode* mode = _get_const_basemode(options);
+    while((status = _next_token(result, stream, &arg)) > 0)
     {
-        len = len + 1; /* +1: for newline */
+        if(!stream->endofoptions && arg[0] == '-' && arg[1] == 0) /* single dash (-) */
+        {
+            /* FIXME: handle single dash */
+        }
+        else if(!stream->endofoptions && arg[0] == '-' && arg[1] == '-' && arg[2] == 0) /* end of options (--) */
+        {
+            stream->endofoptions = 1;
+        }
+        /* special help mode (-h/--help as *first* argument) */
+        else if(!stream->endofoptions &&
+            (
+                (arg[0] == '-' && arg[1] == 'h') ||
+                (arg[0] == '-' && arg[1] == '-' && arg[2] == 'h' && arg[3] == 'e' && arg[4] == 'l' && arg[5] == 'p')
+            ) /* yes, it's ugly, but simple */
+        )
+        {
+            stream->endofoptions = 1; /* causes all subsequent parameters to be parsed as positional parameters */
+            if(stream->callback)
+            {
+                _init_event(&event, stream, CMDOPTIONS_EVENT_OPTION);
+                event.short_identifier = 'h';
+                event.long_identifier = "help";
+                if(!stream->callback(&event, stream->userdata))
+                {
+                    return 0;
+                }
+            }
+            else
+            {
+                result->help_passed = 1;
+            }
+        }
+        else if(!stream->endofoptions && first && arg[0] != '-') /* mode */
+        {
+            /* FIXME: the current parsing does not support command lines such as:
+             * cmd --generic-option mode --mode-argument 42
+             */
+            mode = _find_const_mode(result, arg);
+            if(!mode) /* non-existing mode is a parse error */
+            {
+                return stream->callback ? _parse_error(stream, "unknown mode", arg) : 0;
+            }
+            stream->modename = mode->identifier;
+            if(stream->callback)
+            {
+                _init_event(&event, stream, CMDOPTIONS_EVENT_MODE);
+                if(!stream->callback(&event, stream->userdata))
+                {
+                    return 0;
+                }
+            }
+            else if(!result->modes[mode->id].was_selected)
+            {
+                result->modes[mode->id].was_selected = 1;
+                result->modes[mode->id].next_selected = result->selected;
+                result->selected = mode;
+            }
+        }
+        else if(!stream->endofoptions && arg[0] == '-') /* option */
+        {
+            if(arg[1] == '-') /* long option */
+            {
+                const char* longopt = arg + 2;
+                const struct option* option = _get_const_option(result, mode, 0, longopt);
+                if(!option)
+                {
+                    return _parse_error(stream, "unknown command line option:", arg);
+                }
+                else
+                {
+                    if(_state(result, option)->was_provided && !(option->numargs & MULTI_ARGS))
+                    {
+                        printf("option '%s' is only allowed once\n", longopt);
+                    }
+                    if(!_handle_option(result, option, stream))
+                    {
+                        return 0;
+                    }
+                }
+            }
+            else /* short option */
+            {
+                const char* ch = arg + 1;
+                while(*ch)
+                {
+                    char shortopt = *ch;
+                    const struct option* option = _get_const_option(result, mode, shortopt, NULL);
+                    if(!option)
+                    {
+                        identifier[0] = '-';
+                        identifier[1] = shortopt;
+                        identifier[2] = 0;
+                        return _parse_error(stream, "unknown command line option:", identifier);
+                    }
+                    else
+                    {
+                        if(_state(result, option)->was_provided && !(option->numargs & MULTI_ARGS))
+                        {
+                            printf("option '%c' is only allowed once\n", shortopt);
+                            return 0;
+                        }
+                        if(!_handle_option(result, option, stream))
+                        {
+                            return 0;
+                        }
+                    }
+                    ++ch;
+                }
+            }
+        }
+        else /* positional parameter */
+        {
+            if(stream->callback)
+            {
+                _init_event(&event, stream, CMDOPTIONS_EVENT_POSITIONAL);
+                event.value = arg;
+                if(!stream->callback(&event, stream->userdata))
+                {
+                    return 0;
+                }
+            }
+            else if(!_add_positional_parameter(result, arg))
+            {
+                return 0;
+            }
+        }
+        first = 0;
+        _release_popped(result, stream);
     }
-    char* str = realloc(options->prehelpmsg, len + 1);
-    if(!str)
+    return status == 0;
+}
+
+/* records the state cmdoptions_reset returns to, done by the first parse after the definition changed */
+static void _mark(struct cmdoptions* options)
+{
+    if(options->marked)
     {
-        options->valid = 0;
         return;
     }
-    if(!empty)
+    options->marked = 1;
+    options->mark_valid = options->valid;
+    if(options->arena)
     {
-        strcat(str, "\n");
+        options->mark_block = options->arena;
+        options->mark_used = options->arena->used;
+        options->mark_last = options->arena->last;
+        options->mark_positional = options->result->positional_parameters;
+        options->mark_positional_capacity = options->result->positional_parameters_capacity;
     }
-    strcat(str, msg);
-    options->prehelpmsg = str;
+#ifdef CMDOPTIONS_ENABLE_STATS
+    options->mark_heap_size = options->stats.heap_size;
+#endif
 }
 
-void cmdoptions_append_help_message(struct cmdoptions* options, const char* msg)
+/* gives back everything allocated on the arena since _mark */
+static void _rewind_arena(struct cmdoptions* options)
 {
-    int empty = options->posthelpmsg[0] == 0;
-    size_t len = strlen(options->posthelpmsg) + strlen(msg);
-    if(!empty)
+    struct arena_block* block;
+    while(options->arena != options->mark_block)
     {
-        len = len + 1; /* +1: for newline */
+        block = options->arena;
+        options->arena = block->next;
+        options->allocator.deallocate(options->allocator.context, block);
     }
-    char* str = realloc(options->posthelpmsg, len + 1);
-    if(!str)
+    options->arena->used = options->mark_used;
+    options->arena->last = options->mark_last;
+    options->result->positional_parameters = options->mark_positional;
+    options->result->positional_parameters_capacity = options->mark_positional_capacity;
+    options->result->positional_parameters[0] = NULL;
+#ifdef CMDOPTIONS_ENABLE_STATS
+    options->stats.heap_size = options->mark_heap_size;
+#endif
+}
+
+/*
+ * only the options and modes on the provided/selected lists are touched, so the cost depends on the
+ * last command line and not on the size of the definition
+ * with rewind set, the memory is not freed piece by piece, because the arena is rewound afterwards
+ */
+static void _reset_result(struct cmdoptions_result* result, int rewind)
+{
+    size_t i;
+    const struct option* option;
+    const struct mode* mode;
+    struct option_state* state;
+    while(result->provided)
     {
-        options->valid = 0;
-        return;
+        option = result->provided;
+        state = _state(result, option);
+        result->provided = state->next_provided;
+        state->next_provided = NULL;
+        state->was_provided = 0;
+        if(rewind)
+        {
+            state->argument = NULL;
+            state->argument_size = 0;
+            state->argument_capacity = 0;
+        }
+        else
+        {
+            _clear_argument(result, option);
+        }
     }
-    if(!empty)
+    while(result->selected)
+    {
+        mode = result->selected;
+        result->selected = result->modes[mode->id].next_selected;
+        result->modes[mode->id].next_selected = NULL;
+        result->modes[mode->id].was_selected = 0;
+    }
+    if(!rewind && !result->positional_parameters_borrowed)
+    {
+        for(i = 0; i < result->positional_parameters_size; ++i)
+        {
+            _result_free(result, result->positional_parameters[i]);
+        }
+    }
+    _release_response_files(result);
+    result->positional_parameters_size = 0;
+    result->positional_parameters[0] = NULL;
+    result->positional_parameters_borrowed = 0;
+    result->help_passed = 0;
+    result->valid = 1;
+}
+
+void cmdoptions_reset(struct cmdoptions* options)
+{
+    int rewind = options->marked && options->arena;
+    _reset_result(options->result, rewind);
+    if(rewind)
+    {
+        _rewind_arena(options);
+    }
+    if(options->marked)
+    {
+        options->valid = options->mark_valid;
+    }
+}
+
+void cmdoptions_result_reset(struct cmdoptions_result* result)
+{
+    _reset_result(result, 0);
+}
+
+int cmdoptions_parse(struct cmdoptions* options, int argc, const char* const * argv)
+{
+    struct token_stream stream;
+    int ret;
+    _STATS_TIMER(start)
+    _STATS_START(start);
+    _mark(options);
+    _open_stream(&stream, argc, argv, options->expand_response_files);
+    ret = _parse_stream(options->result, &stream);
+    _close_stream(options->result, &stream); /* response files that are still open after an error */
+    _STATS_STOP(_STATS(options), parses, parse_time, start);
+    return ret;
+}
+
+int cmdoptions_parse_string(struct cmdoptions* options, char* str)
+{
+    struct token_stream stream;
+    int ret;
+    _STATS_TIMER(start)
+    _STATS_START(start);
+    _mark(options);
+    _open_string_stream(&stream, str, options->expand_response_files);
+    ret = _parse_stream(options->result, &stream);
+    _close_stream(options->result, &stream);
+    _STATS_STOP(_STATS(options), parses, parse_time, start);
+    return ret;
+}
+
+int cmdoptions_parse_events(struct cmdoptions* options, int argc, const char* const * argv, int (*callback)(const struct cmdoptions_event* event, void* userdata), void* userdata)
+{
+    struct token_stream stream;
+    int ret;
+    _STATS_TIMER(start)
+    _STATS_START(start);
+    _mark(options);
+    _open_stream(&stream, argc, argv, options->expand_response_files);
+    stream.callback = callback;
+    stream.userdata = userdata;
+    ret = _parse_stream(options->result, &stream);
+    _close_stream(options->result, &stream);
+    _STATS_STOP(_STATS(options), parses, parse_time, start);
+    return ret;
+}
+
+/* the definition is only read from now on, so any number of results can use it at the same time */
+void cmdoptions_freeze(struct cmdoptions* options)
+{
+    options->frozen = 1;
+}
+
+struct cmdoptions_result* cmdoptions_result_create(const struct cmdoptions* options)
+{
+    struct cmdoptions_result* result;
+    if(!options->frozen)
+    {
+        fprintf(stderr, "results can only be created for frozen command-line definitions\n");
+        return NULL;
+    }
+    result = options->allocator.allocate(options->allocator.context, sizeof(*result));
+    if(!result)
+    {
+        return NULL;
+    }
+    if(!_init_result(result, options, NULL) || !_reserve_result(result, options->noptions, options->size))
+    {
+        _result_free(result, result->positional_parameters);
+        _result_free(result, result->states);
+        _result_free(result, result->modes);
+        options->allocator.deallocate(options->allocator.context, result);
+        return NULL;
+    }
+    return result;
+}
+
+void cmdoptions_result_destroy(struct cmdoptions_result* result)
+{
+    struct cmdoptions_allocator allocator = result->allocator;
+    _destroy_result(result);
+    allocator.deallocate(allocator.context, result);
+}
+
+int cmdoptions_result_is_valid(const struct cmdoptions_result* result)
+{
+    return result->valid;
+}
+
+int cmdoptions_result_parse(struct cmdoptions_result* result, int argc, const char* const * argv)
+{
+    struct token_stream stream;
+    int ret;
+    _STATS_TIMER(start)
+    _STATS_START(start);
+    _open_stream(&stream, argc, argv, result->options->expand_response_files);
+    ret = _parse_stream(result, &stream);
+    _close_stream(result, &stream);
+    _STATS_STOP(_RESULT_STATS(result), parses, parse_time, start);
+    return ret;
+}
+
+int cmdoptions_result_parse_string(struct cmdoptions_result* result, char* str)
+{
+    struct token_stream stream;
+    int ret;
+    _STATS_TIMER(start)
+    _STATS_START(start);
+    _open_string_stream(&stream, str, result->options->expand_response_files);
+    ret = _parse_stream(result, &stream);
+    _close_stream(result, &stream);
+    _STATS_STOP(_RESULT_STATS(result), parses, parse_time, start);
+    return ret;
+}
+
+/* batch parsing: a file with one command line per line, split into chunks of lines that are parsed by a pool of workers */
+#define BATCH_LINES 32
+
+struct batch {
+    const struct cmdoptions* options;
+    const char* path; /* program name of every line */
+    char** chunks; /* start of every BATCH_LINES-th line, followed by the end of the file */
+    size_t nchunks;
+    int ordered;
+    int (*callback)(struct cmdoptions_result* result, size_t line, int parsed, void* userdata);
+    void* userdata;
+    size_t next; /* next chunk to parse */
+    size_t delivered; /* number of chunks passed to the callback (only if ordered) */
+    int stop;
+    int valid;
+#ifdef CMDOPTIONS_ENABLE_THREADS
+    pthread_mutex_t lock;
+    pthread_cond_t turn; /* signaled when delivered changes or stop is set */
+#endif
+};
+
+struct batch_worker {
+    struct batch* batch;
+    struct cmdoptions_result* results[BATCH_LINES]; /* one per line of a chunk if ordered, otherwise only the first one */
+    int parsed[BATCH_LINES]; /* parse status or -1 for empty lines */
+    const char** argv;
+    size_t capacity;
+#ifdef CMDOPTIONS_ENABLE_THREADS
+    pthread_t thread;
+#endif
+};
+
+static void _batch_lock(struct batch* batch)
+{
+#ifdef CMDOPTIONS_ENABLE_THREADS
+    pthread_mutex_lock(&batch->lock);
+#else
+    (void)batch;
+#endif
+}
+
+static void _batch_unlock(struct batch* batch)
+{
+#ifdef CMDOPTIONS_ENABLE_THREADS
+    pthread_mutex_unlock(&batch->lock);
+#else
+    (void)batch;
+#endif
+}
+
+static void _batch_stop(struct batch* batch, int valid)
+{
+    _batch_lock(batch);
+    batch->stop = 1;
+    batch->valid &= valid;
+#ifdef CMDOPTIONS_ENABLE_THREADS
+    pthread_cond_broadcast(&batch->turn);
+#endif
+    _batch_unlock(batch);
+}
+
+static int _batch_next_chunk(struct batch* batch, size_t* chunk)
+{
+    int found;
+    _batch_lock(batch);
+    found = !batch->stop && batch->next < batch->nchunks;
+    if(found)
     {
-        strcat(str, "\n");
+        *chunk = batch->next;
+        batch->next += 1;
     }
-    strcat(str, msg);
-    options->posthelpmsg = str;
+    _batch_unlock(batch);
+    return found;
 }
 
-static void _print_sep(unsigned int num)
+/* ordered: wait until all previous chunks were delivered, returns 0 if the batch was stopped */
+static int _batch_wait_turn(struct batch* batch, size_t chunk)
 {
-    unsigned int i;
-    for(i = 0; i < num; ++i)
+    int turn;
+    _batch_lock(batch);
+#ifdef CMDOPTIONS_ENABLE_THREADS
+    while(!batch->stop && batch->delivered != chunk)
     {
-        putchar(' ');
+        pthread_cond_wait(&batch->turn, &batch->lock);
     }
+#else
+    (void)chunk;
+#endif
+    turn = !batch->stop;
+    _batch_unlock(batch);
+    return turn;
 }
 
-#define _MAX(a, b) ((a) > (b) ? (a) : (b))
+static void _batch_end_turn(struct batch* batch)
+{
+    _batch_lock(batch);
+    batch->delivered += 1;
+#ifdef CMDOPTIONS_ENABLE_THREADS
+    pthread_cond_broadcast(&batch->turn);
+#endif
+    _batch_unlock(batch);
+}
 
-static void _find_max_opt_width(const struct cmdoptions* options, unsigned int* optwidth)
+/* split a line into the argv of the worker in place, returns 1 on success, 0 if out of memory and -1 for unterminated quotes */
+static int _batch_tokenize(struct batch_worker* worker, char* cursor, char* end, int* argc)
 {
-    size_t i;
-    size_t m;
-    struct mode* mode;
-    for(m = 0; m < options->size; ++m)
+    const struct cmdoptions_allocator* allocator = &worker->batch->options->allocator;
+    char* word;
+    int status;
+    *argc = 1;
+    while((status = _next_word(&cursor, end, &word)) > 0)
     {
-        mode = options->modes[m];
-        for(i = 0; i < mode->entries_size; ++i)
+        if((size_t)*argc + 1 >= worker->capacity)
         {
-            struct entry* entry = mode->entries[i];
-            if(entry->what == OPTION)
+            size_t capacity = worker->capacity * 2;
+            const char** argv = allocator->reallocate(allocator->context, (void*)worker->argv, capacity * sizeof(*argv));
+            if(!argv)
             {
-                struct option* option = entry->value;
-                if(option->short_identifier && !option->long_identifier)
-                {
-                    *optwidth = _MAX(*optwidth, 2); /* 2: -%c */
-                }
-                else if(!option->short_identifier && option->long_identifier)
-                {
-                    *optwidth = _MAX(*optwidth, strlen(option->long_identifier) + 2); /* + 2: -- */
-                }
-                else
-                {
-                    *optwidth = _MAX(*optwidth, 2 + 1 + strlen(option->long_identifier) + 2); /* +1: , */
-                }
+                return 0;
             }
+            worker->argv = argv;
+            worker->capacity = capacity;
         }
+        worker->argv[*argc] = word;
+        *argc += 1;
     }
-
+    worker->argv[*argc] = NULL;
+    return status == 0 ? 1 : -1;
 }
 
-static void _print_help_entry(const struct entry* entry, unsigned int startskip, unsigned int leftmargin, unsigned int textwidth, unsigned int optwidth, unsigned int helpsep, int narrow)
+/* parse the lines of one chunk, unordered lines are passed to the callback right away */
+static int _batch_parse_chunk(struct batch_worker* worker, size_t chunk, size_t* count)
 {
-    unsigned int count;
-    if(entry->what == SECTION)
-    {
-        struct section* section = entry->value;
-        puts(section->name);
-    }
-    else
+    struct batch* batch = worker->batch;
+    char* cursor = batch->chunks[chunk];
+    char* end = batch->chunks[chunk + 1];
+    char* eol;
+    int argc;
+    int status;
+    size_t i = 0;
+    while(cursor < end)
     {
-        struct option* option = entry->value;
-        _print_sep(startskip);
-        count = optwidth;
-        if(option->short_identifier)
+        size_t line = chunk * BATCH_LINES + i + 1;
+        struct cmdoptions_result* result = worker->results[batch->ordered ? i : 0];
+        eol = memchr(cursor, '\n', end - cursor);
+        if(!eol)
         {
-            putchar('-');
-            putchar(option->short_identifier);
-            count -= 2;
+            eol = end; /* last line without newline, the file provides one byte after its end */
         }
-        if(option->short_identifier && option->long_identifier)
+        status = _batch_tokenize(worker, cursor, eol, &argc);
+        cursor = eol + 1;
+        if(status == 0)
         {
-            putchar(',');
-            count -= 1;
+            return 0;
         }
-        if(option->long_identifier)
+        if(status < 0)
         {
-            putchar('-');
-            putchar('-');
-            fputs(option->long_identifier, stdout);
-            count -= (2 + strlen(option->long_identifier));
+            printf("unterminated quote in line %lu\n", (unsigned long)line);
+            worker->parsed[i] = 0;
         }
-        if(narrow)
+        else
         {
-            putchar('\n');
-            _print_sep(2 * startskip);
+            worker->parsed[i] = argc > 1 ? cmdoptions_result_parse(result, argc, worker->argv) : -1;
         }
-        else
+        if(!batch->ordered && worker->parsed[i] >= 0)
         {
-            _print_sep(helpsep + count);
+            int proceed = batch->callback(result, line, worker->parsed[i], batch->userdata);
+            cmdoptions_result_reset(result);
+            if(!proceed)
+            {
+                _batch_stop(batch, 1);
+                break;
+            }
         }
-        leftmargin = narrow ? 2 * startskip : startskip + optwidth + helpsep;
-        print_wrapped_paragraph(option->help, textwidth, leftmargin);
+        ++i;
     }
+    *count = i;
+    return 1;
 }
 
-size_t _number_of_passed_options(const struct cmdoptions* options)
+static void* _batch_work(void* arg)
 {
-    size_t count = 0;
-    struct mode* mode;
-    size_t m;
+    struct batch_worker* worker = arg;
+    struct batch* batch = worker->batch;
+    size_t chunk;
+    size_t count;
     size_t i;
-    for(m = 0; m < options->size; ++m)
+    while(_batch_next_chunk(batch, &chunk))
     {
-        mode = options->modes[m];
-        for(i = 0; i < mode->entries_size; ++i)
+        if(!_batch_parse_chunk(worker, chunk, &count))
         {
-            const struct entry* entry = mode->entries[i];
-            if(entry->what == OPTION)
+            _batch_stop(batch, 0);
+            break;
+        }
+        if(!batch->ordered)
+        {
+            continue;
+        }
+        if(!_batch_wait_turn(batch, chunk))
+        {
+            break;
+        }
+        for(i = 0; i < count; ++i)
+        {
+            if(worker->parsed[i] >= 0)
             {
-                struct option* option = entry->value;
-                if(option->was_provided)
+                int proceed = batch->callback(worker->results[i], chunk * BATCH_LINES + i + 1, worker->parsed[i], batch->userdata);
+                cmdoptions_result_reset(worker->results[i]);
+                if(!proceed)
                 {
-                    ++count;
+                    _batch_stop(batch, 1);
+                    return NULL;
                 }
             }
         }
+        _batch_end_turn(batch);
     }
-    return count;
+    return NULL;
 }
 
-static int _no_positional_parameters(const struct cmdoptions* options);
-int cmdoptions_help(const struct cmdoptions* options)
+/* record the start of every BATCH_LINES-th line */
+static int _batch_split(struct batch* batch, char* data, size_t size)
 {
-    /* FIXME: include modes */
-    unsigned int displaywidth = 80;
-    unsigned int optwidth = 0;
-    unsigned int i;
-    unsigned int startskip = 4;
-    unsigned int helpsep = 4;
-    unsigned int leftmargin = 0;
-    unsigned int rightmargin = 1;
-    int narrow;
-    unsigned int offset;
-    unsigned int textwidth;
-    size_t m;
-    const struct mode* mode;
-    const char** pospar;
-
-    displaywidth = print_get_screen_width();
-
-    _find_max_opt_width(options, &optwidth);
-
-    narrow = options->force_narrow_mode || (displaywidth < 100); /* FIXME: make dynamic (dependent on maximum word width or something) */
-
-    offset = narrow ? 2 * startskip : optwidth + startskip + helpsep;
-    textwidth = displaywidth - offset - leftmargin - rightmargin;
-
-    if(!_no_positional_parameters(options)) /* additional options are present, only print those */
+    const struct cmdoptions_allocator* allocator = &batch->options->allocator;
+    char* cursor = data;
+    char* end = data + size;
+    size_t capacity = 64;
+    size_t lines = 0;
+    batch->nchunks = 0;
+    batch->chunks = allocator->allocate(allocator->context, capacity * sizeof(*batch->chunks));
+    if(!batch->chunks)
     {
-        mode = _get_const_basemode(options);
-        pospar = cmdoptions_get_positional_parameters(options);
-        while(*pospar)
+        return 0;
+    }
+    while(cursor < end)
+    {
+        char* eol;
+        if(lines % BATCH_LINES == 0)
         {
-            int printed = 0;
-            for(i = 0; i < mode->entries_size; ++i)
+            if(batch->nchunks + 1 == capacity)
             {
-                const struct entry* entry = mode->entries[i];
-                if(entry->what == OPTION)
+                char** chunks = allocator->reallocate(allocator->context, batch->chunks, capacity * 2 * sizeof(*chunks));
+                if(!chunks)
                 {
-                    struct option* option = entry->value;
-                    if((*pospar)[1] == 0) /* single character */
-                    {
-                        if(**pospar == option->short_identifier)
-                        {
-                            printed = 1;
-                            _print_help_entry(entry, startskip, leftmargin, textwidth, optwidth, helpsep, narrow);
-                        }
-                    }
-                    else if(((*pospar)[0] == '-') && ((*pospar)[1] != 0) && ((*pospar)[2] == 0)) /* single character with dash */
-                    {
-                        if((*pospar)[1] == option->short_identifier)
-                        {
-                            printed = 1;
-                            _print_help_entry(entry, startskip, leftmargin, textwidth, optwidth, helpsep, narrow);
-                        }
-                    }
-                    else /* multi-character */
-                    {
-                        char* identifier = malloc(strlen(*pospar) + 1);
-                        if(((*pospar)[0] == '-') && (*pospar)[1] == '-') /* starts with two dashes */
-                        {
-                            strcpy(identifier, *pospar + 2);
-                        }
-                        else
-                        {
-                            strcpy(identifier, *pospar);
-                        }
-                        if(strstr(option->long_identifier, identifier)) /* (partial) match */
-                        {
-                            printed = 1;
-                            _print_help_entry(entry, startskip, leftmargin, textwidth, optwidth, helpsep, narrow);
-                        }
-                        free(identifier);
-                    }
+                    return 0;
                 }
+                batch->chunks = chunks;
+                capacity *= 2;
             }
-            if(!printed)
-            {
-                fprintf(stderr, "help: option '%s' not found\n", *pospar);
-                return 0;
-            }
-            ++pospar;
+            batch->chunks[batch->nchunks] = cursor;
+            batch->nchunks += 1;
         }
-        /* FIXME: also enable for modes, although cmdline syntax is unclear */
+        eol = memchr(cursor, '\n', end - cursor);
+        cursor = eol ? eol + 1 : end;
+        ++lines;
     }
-    else /* no additional options, print all */
+    batch->chunks[batch->nchunks] = end;
+    return 1;
+}
+
+static unsigned int _batch_threads(unsigned int threads, size_t nchunks)
+{
+#ifdef CMDOPTIONS_ENABLE_THREADS
+    if(threads == 0)
     {
-        puts(options->prehelpmsg);
-        puts("list of command line options:\n");
-        if(options->size > 1)
-        {
-            printf("%s:\n", "generic options");
-        }
-        mode = _get_const_basemode(options);
-        for(i = 0; i < mode->entries_size; ++i)
-        {
-            const struct entry* entry = mode->entries[i];
-            _print_help_entry(entry, startskip, leftmargin, textwidth, optwidth, helpsep, narrow);
-        }
-        putchar('\n');
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned int)online : 1;
+    }
+#else
+    threads = 1; /* the calling thread does all the work */
+#endif
+    if(threads > nchunks)
+    {
+        threads = nchunks > 0 ? (unsigned int)nchunks : 1;
+    }
+    return threads;
+}
 
-        for(m = 1; m < options->size; ++m)
+static int _init_batch_worker(struct batch_worker* worker, struct batch* batch)
+{
+    const struct cmdoptions_allocator* allocator = &batch->options->allocator;
+    size_t i;
+    size_t nresults = batch->ordered ? BATCH_LINES : 1;
+    worker->batch = batch;
+    for(i = 0; i < BATCH_LINES; ++i)
+    {
+        worker->results[i] = NULL;
+    }
+    worker->capacity = 16;
+    worker->argv = allocator->allocate(allocator->context, worker->capacity * sizeof(*worker->argv));
+    if(!worker->argv)
+    {
+        return 0;
+    }
+    worker->argv[0] = batch->path;
+    for(i = 0; i < nresults; ++i)
+    {
+        worker->results[i] = cmdoptions_result_create(batch->options);
+        if(!worker->results[i])
         {
-            mode = options->modes[m];
-            printf("%s:\n", mode->identifier);
-            for(i = 0; i < mode->entries_size; ++i)
-            {
-                const struct entry* entry = mode->entries[i];
-                _print_help_entry(entry, startskip, leftmargin, textwidth, optwidth, helpsep, narrow);
-            }
-            putchar('\n');
+            return 0;
         }
-        fputs(options->posthelpmsg, stdout);
-        fputc('\n', stdout);
     }
     return 1;
 }
 
-static void _print_with_correct_escape_sequences(const char* str)
+static void _destroy_batch_worker(struct batch_worker* worker)
 {
-    unsigned int numescape = 0;
-    const char* ptr = str;
-    size_t len = strlen(str);
-    char* buf;
-    char* dest;
-
-    /* count number of required escapes */
-    while(*ptr)
+    const struct cmdoptions_allocator* allocator = &worker->batch->options->allocator;
+    size_t i;
+    for(i = 0; i < BATCH_LINES && worker->results[i]; ++i)
     {
-        if(*ptr == '\\')
-        {
-            ++numescape;
-        }
-        ++ptr;
+        cmdoptions_result_destroy(worker->results[i]);
     }
-
-    /* assemble escaped string */
-    buf = malloc(len + numescape + 1);
-    ptr = str;
-    dest = buf;
-    while(*ptr)
+    if(worker->argv)
     {
-        *dest = *ptr;
-        if(*ptr == '\\')
-        {
-            *(dest + 1) = '\\';
-            ++dest;
-        }
-        ++ptr;
-        ++dest;
+        allocator->deallocate(allocator->context, (void*)worker->argv);
     }
-    *dest = 0;
-    puts(buf);
-    free(buf);
 }
 
-void cmdoptions_export_manpage(const struct cmdoptions* options)
+int cmdoptions_parse_batch(const struct cmdoptions* options, const char* path, unsigned int threads, int flags, int (*callback)(struct cmdoptions_result* result, size_t line, int parsed, void* userdata), void* userdata)
 {
-    unsigned int m;
+    const struct cmdoptions_allocator* allocator = &options->allocator;
+    struct batch batch;
+    struct batch_worker* workers;
+    struct response_file file;
+    unsigned int nworkers;
     unsigned int i;
-    struct mode* mode;
-    for(m = 0; m < options->size; ++m)
+    batch.options = options;
+    batch.path = path;
+    batch.chunks = NULL;
+    batch.ordered = (flags & CMDOPTIONS_BATCH_ORDERED) != 0;
+    batch.callback = callback;
+    batch.userdata = userdata;
+    batch.next = 0;
+    batch.delivered = 0;
+    batch.stop = 0;
+    batch.valid = 1;
+    workers = allocator->allocate(allocator->context, sizeof(*workers));
+    if(!workers || !_init_batch_worker(&workers[0], &batch)) /* the calling thread is the first worker, its result also reads the file */
     {
-        mode = options->modes[m];
-        for(i = 0; i < mode->entries_size; ++i)
+        if(workers)
         {
-            struct entry* entry = mode->entries[i];
-            if(entry->what == OPTION)
-            {
-                struct option* option = entry->value;
-                fputs(".IP \"\\fB\\", stdout);
-                if(option->short_identifier && option->long_identifier)
-                {
-                    fputc('-', stdout);
-                    fputc(option->short_identifier, stdout);
-                    fputc(',', stdout);
-                    fputc('-', stdout);
-                    fputc('-', stdout);
-                    fputs(option->long_identifier, stdout);
-                }
-                else if(option->short_identifier)
-                {
-                    fputc('-', stdout);
-                    fputc(option->short_identifier, stdout);
-                }
-                else if(option->long_identifier)
-                {
-                    fputc('-', stdout);
-                    fputc('-', stdout);
-                    fputs(option->long_identifier, stdout);
-                }
-                printf("\\fR %s\" 4\n", "");
-                _print_with_correct_escape_sequences(option->help);
-            }
-            else /* section */
-            {
-                struct section* section = entry->value;
-                printf(".SS %s\n", section->name);
-            }
+            _destroy_batch_worker(&workers[0]);
+            allocator->deallocate(allocator->context, workers);
         }
+        return 0;
     }
-}
-
-static struct option* _get_option(struct mode* mode, char short_identifier, const char* long_identifier)
-{
-    unsigned int i;
-    int found = 0;
-    for(i = 0; i < mode->entries_size; ++i)
+    if(!_read_response_file(workers[0].results[0], path, &file))
     {
-        struct entry* entry = mode->entries[i];
-        if(entry->what == OPTION)
+        printf("could not read batch file '%s'\n", path);
+        _destroy_batch_worker(&workers[0]);
+        allocator->deallocate(allocator->context, workers);
+        return 0;
+    }
+    nworkers = 1;
+    if(!_batch_split(&batch, file.data, file.size))
+    {
+        batch.valid = 0;
+        goto CLEANUP;
+    }
+    threads = _batch_threads(threads, batch.nchunks);
+#ifdef CMDOPTIONS_ENABLE_THREADS
+    if(threads > 1)
+    {
+        struct batch_worker* grown = allocator->reallocate(allocator->context, workers, threads * sizeof(*workers));
+        if(grown)
         {
-            struct option* option = entry->value;
-            if(long_identifier)
-            {
-                found = (strcmp(option->long_identifier, long_identifier) == 0);
-            }
-            else
-            {
-                found = (option->short_identifier == short_identifier);
-            }
-            if(found)
-            {
-                if(option->aliased)
-                {
-                    return option->aliased;
-                }
-                else
-                {
-                    return option;
-                }
-            }
+            workers = grown;
+        }
+        else
+        {
+            threads = 1;
         }
     }
-    return NULL;
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_cond_init(&batch.turn, NULL);
+    /* with fewer workers than requested, the batch is still parsed completely */
+    for(; nworkers < threads; ++nworkers)
+    {
+        if(!_init_batch_worker(&workers[nworkers], &batch))
+        {
+            _destroy_batch_worker(&workers[nworkers]);
+            break;
+        }
+        if(pthread_create(&workers[nworkers].thread, NULL, _batch_work, &workers[nworkers]) != 0)
+        {
+            _destroy_batch_worker(&workers[nworkers]);
+            break;
+        }
+    }
+    _batch_work(&workers[0]);
+    for(i = 1; i < nworkers; ++i)
+    {
+        pthread_join(workers[i].thread, NULL);
+    }
+    pthread_cond_destroy(&batch.turn);
+    pthread_mutex_destroy(&batch.lock);
+#else
+    (void)threads;
+    _batch_work(&workers[0]);
+#endif
+CLEANUP:
+    if(batch.chunks)
+    {
+        allocator->deallocate(allocator->context, batch.chunks);
+    }
+    _release_file_data(workers[0].results[0], &file);
+    for(i = 0; i < nworkers; ++i)
+    {
+        _destroy_batch_worker(&workers[i]);
+    }
+    allocator->deallocate(allocator->context, workers);
+    if(!batch.valid)
+    {
+        return 0;
+    }
+    return batch.stop ? CMDOPTIONS_BATCH_STOPPED : 1;
 }
 
-static const struct option* _get_const_option(const struct mode* mode, char short_identifier, const char* long_identifier)
+static const void* _get_argument(const struct cmdoptions_result* result, const struct option* option)
 {
-    unsigned int i;
-    int found = 0;
-    for(i = 0; i < mode->entries_size; ++i)
+    const struct option_state* state;
+    if(option)
     {
-        struct entry* entry = mode->entries[i];
-        if(entry->what == OPTION)
+        state = _state(result, option);
+        if(option->numargs & ARG_TYPE_MASK)
         {
-            struct option* option = entry->value;
-            if(long_identifier)
-            {
-                found = (strcmp(option->long_identifier, long_identifier) == 0);
-            }
-            else
+            if(state->was_provided)
             {
-                found = (option->short_identifier == short_identifier);
+                return (option->numargs & MULTI_ARGS) ? state->argument : (const void*)&state->value;
             }
-            if(found)
-            {
-                if(option->aliased)
-                {
-                    return option->aliased;
-                }
-                else
-                {
-                    return option;
-                }
+            if(!option->default_argument)
+            {
+                return NULL;
             }
+            return (option->numargs & MULTI_ARGS) ? _typed_element(option->numargs, &option->default_value) : (const void*)&option->default_value;
         }
+        return state->was_provided ? state->argument : option->default_argument;
     }
     return NULL;
 }
 
-const char** cmdoptions_get_positional_parameters(const struct cmdoptions* options)
+const void* cmdoptions_result_get_argument_short(const struct cmdoptions_result* result, char short_identifier)
 {
-    return (const char**) options->positional_parameters;
+    const struct mode* mode = _get_const_basemode(result->options);
+    return _get_argument(result, _get_const_option(result, mode, short_identifier, NULL));
 }
 
-static int _no_positional_parameters(const struct cmdoptions* options)
+const void* cmdoptions_get_argument_short(struct cmdoptions* options, char short_identifier)
 {
-    unsigned int count = 0;
-    char** p = options->positional_parameters;
-    while(*p)
+    return cmdoptions_result_get_argument_short(options->result, short_identifier);
+}
+
+const void* cmdoptions_result_mode_get_argument_short(const struct cmdoptions_result* result, const char* modename, char short_identifier)
+{
+    const struct mode* mode = _find_const_mode(result, modename);
+    if(!mode)
     {
-        ++count;
-        ++p;
+        fprintf(stderr, "trying to access command-line option '%c' of mode '%s'. This mode does not exist\n", short_identifier, modename);
+        return NULL;
     }
-    return count == 0;
+    return _get_argument(result, _get_const_option(result, mode, short_identifier, NULL));
 }
 
-int cmdoptions_help_passed(struct cmdoptions* options)
+const void* cmdoptions_mode_get_argument_short(struct cmdoptions* options, const char* modename, char short_identifier)
 {
-    return options->help_passed;
+    return cmdoptions_result_mode_get_argument_short(options->result, modename, short_identifier);
 }
 
-int cmdoptions_empty(const struct cmdoptions* options)
+const void* cmdoptions_result_get_argument_long(const struct cmdoptions_result* result, const char* long_identifier)
 {
-    return cmdoptions_no_args_given(options) && _no_positional_parameters(options);
+    const struct mode* mode = _get_const_basemode(result->options);
+    return _get_argument(result, _get_const_option(result, mode, 0, long_identifier));
 }
 
-static int _no_args_given(const struct mode* mode)
+const void* cmdoptions_get_argument_long(struct cmdoptions* options, const char* long_identifier)
 {
-    unsigned int i;
-    for(i = 0; i < mode->entries_size; ++i)
-    {
-        const struct entry* entry = mode->entries[i];
-        if(entry->what == OPTION)
-        {
-            const struct option* option = entry->value;
-            if(option->was_provided)
-            {
-                return 0;
-            }
-        }
-    }
-    return 1;
+    return cmdoptions_result_get_argument_long(options->result, long_identifier);
 }
 
-int cmdoptions_no_args_given(const struct cmdoptions* options)
+const void* cmdoptions_result_mode_get_argument_long(const struct cmdoptions_result* result, const char* modename, const char* long_identifier)
 {
-    unsigned int m;
-    int ret = 1;
-    for(m = 0; m < options->size; ++m)
+    const struct mode* mode = _find_const_mode(result, modename);
+    if(!mode)
     {
-        const struct mode* mode = options->modes[m];
-        if(mode->was_selected)
-        {
-            ret = ret && _no_args_given(mode);
-        }
+        fprintf(stderr, "trying to access command-line option '%s' of mode '%s'. This mode does not exist\n", long_identifier, modename);
+        return NULL;
     }
-    return ret;
+    return _get_argument(result, _get_const_option(result, mode, 0, long_identifier));
 }
 
-int cmdoptions_mode_no_args_given(const struct cmdoptions* options, const char* modename)
+const void* cmdoptions_mode_get_argument_long(struct cmdoptions* options, const char* modename, const char* long_identifier)
 {
-    const struct mode* mode = _find_const_mode(options, modename);
-    if(!mode)
-    {
-        fprintf(stderr, "trying to access command-line mode '%s'. This mode does not exist\n", modename);
-        return -1;
-    }
-    return _no_args_given(mode);
+    return cmdoptions_result_mode_get_argument_long(options->result, modename, long_identifier);
 }
 
-static int _was_provided(struct mode* mode, char short_identifier, const char* long_identifier)
+const void* cmdoptions_result_get_argument_id(const struct cmdoptions_result* result, int id)
 {
-    struct option* option = _get_option(mode, short_identifier, long_identifier);
-    if(option)
+    return _get_argument(result, _get_option_id(result->options, id));
+}
+
+const void* cmdoptions_get_argument_id(struct cmdoptions* options, int id)
+{
+    return cmdoptions_result_get_argument_id(options->result, id);
+}
+
+static size_t _argument_count(const struct cmdoptions_result* result, const struct option* option)
+{
+    const struct option_state* state;
+    if(!option || !option->numargs)
     {
-        option->was_checked = 1;
-        return option->was_provided;
+        return 0;
     }
-    return 0;
+    state = _state(result, option);
+    if(!state->was_provided)
+    {
+        return option->default_argument ? 1 : 0;
+    }
+    if(option->numargs & MULTI_ARGS)
+    {
+        return state->argument_size;
+    }
+    return state->argument || (option->numargs & ARG_TYPE_MASK) ? 1 : 0;
 }
 
-static int _was_provided_short(struct mode* mode, char short_identifier)
+size_t cmdoptions_result_get_argument_count_short(const struct cmdoptions_result* result, char short_identifier)
 {
-    return _was_provided(mode, short_identifier, NULL);
+    const struct mode* mode = _get_const_basemode(result->options);
+    return _argument_count(result, _get_const_option(result, mode, short_identifier, NULL));
 }
 
-int cmdoptions_was_provided_short(struct cmdoptions* options, char short_identifier)
+size_t cmdoptions_get_argument_count_short(struct cmdoptions* options, char short_identifier)
 {
-    struct mode* mode = _get_basemode(options);
-    return _was_provided_short(mode, short_identifier);
+    return cmdoptions_result_get_argument_count_short(options->result, short_identifier);
 }
 
-int cmdoptions_mode_was_provided_short(struct cmdoptions* options, const char* modename, char short_identifier)
+size_t cmdoptions_result_mode_get_argument_count_short(const struct cmdoptions_result* result, const char* modename, char short_identifier)
 {
-    struct mode* mode = _find_mode(options, modename);
+    const struct mode* mode = _find_const_mode(result, modename);
     if(!mode)
     {
         fprintf(stderr, "trying to access command-line option '%c' of mode '%s'. This mode does not exist\n", short_identifier, modename);
         return 0;
     }
-    return _was_provided_short(mode, short_identifier);
+    return _argument_count(result, _get_const_option(result, mode, short_identifier, NULL));
 }
 
-static int _was_provided_long(struct mode* mode, const char* long_identifier)
+size_t cmdoptions_mode_get_argument_count_short(struct cmdoptions* options, const char* modename, char short_identifier)
 {
-    return _was_provided(mode, 0, long_identifier);
+    return cmdoptions_result_mode_get_argument_count_short(options->result, modename, short_identifier);
 }
 
-int cmdoptions_was_provided_long(struct cmdoptions* options, const char* long_identifier)
+size_t cmdoptions_result_get_argument_count_long(const struct cmdoptions_result* result, const char* long_identifier)
 {
-    struct mode* mode = _get_basemode(options);
-    return _was_provided_long(mode, long_identifier);
+    const struct mode* mode = _get_const_basemode(result->options);
+    return _argument_count(result, _get_const_option(result, mode, 0, long_identifier));
 }
 
-int cmdoptions_mode_was_provided_long(struct cmdoptions* options, const char* modename, const char* long_identifier)
+size_t cmdoptions_get_argument_count_long(struct cmdoptions* options, const char* long_identifier)
 {
-    struct mode* mode = _find_mode(options, modename);
+    return cmdoptions_result_get_argument_count_long(options->result, long_identifier);
+}
+
+size_t cmdoptions_result_mode_get_argument_count_long(const struct cmdoptions_result* result, const char* modename, const char* long_identifier)
+{
+    const struct mode* mode = _find_const_mode(result, modename);
     if(!mode)
     {
         fprintf(stderr, "trying to access command-line option '%s' of mode '%s'. This mode does not exist\n", long_identifier, modename);
         return 0;
     }
-    return _was_provided_long(mode, long_identifier);
+    return _argument_count(result, _get_const_option(result, mode, 0, long_identifier));
 }
 
-int _store_argument(struct option* option, int* iptr, int argc, const char* const * argv)
+size_t cmdoptions_mode_get_argument_count_long(struct cmdoptions* options, const char* modename, const char* long_identifier)
 {
-    int j;
-    int len;
-    char** argument;
-    if(option->numargs)
-    {
-        if(*iptr < argc - 1)
-        {
-            if(option->numargs & MULTI_ARGS)
-            {
-                if(!option->argument)
-                {
-                    argument = calloc(2, sizeof(char*));
-                    argument[0] = malloc(strlen(argv[*iptr + 1]) + 1);
-                    strcpy(argument[0], argv[*iptr + 1]);
-                    option->argument = argument;
-                }
-                else
-                {
-                    if(!option->was_provided) /* default argument */
-                    {
-                        /* FIXME: this if-branch is currently untested and might result in memory access errors */
-                        char** p = option->argument;
-                        while(*p)
-                        {
-                            free(*p);
-                            ++p;
-                        }
-                        /* start new with only terminator */
-                        free(option->argument);
-                        char** new = malloc(sizeof(*new));
-                        new[0] = NULL;
-                        option->argument = new;
-                    }
-                    char** ptr = option->argument;
-                    while(*ptr) { ++ptr; }
-                    len = ptr - (char**)option->argument;
-                    argument = calloc(len + 2, sizeof(char*));
-                    for(j = 0; j < len; ++j)
-                    {
-                        argument[j] = ((char**)option->argument)[j];
-                    }
-                    argument[len] = malloc(strlen(argv[*iptr + 1]) + 1);
-                    strcpy(argument[len], argv[*iptr + 1]);
-                    free(option->argument);
-                    option->argument = argument;
-                }
-            }
-            else /* SINGLE_ARG option */
-            {
-                if(option->argument && !option->was_provided) /* default argument */
-                {
-                    free(option->argument);
-                }
-                option->argument = malloc(strlen(argv[*iptr + 1]) + 1);
-                strcpy(option->argument, argv[*iptr + 1]);
-            }
-        }
-        else /* argument required, but not entries in argv left */
-        {
-            if(option->long_identifier)
-            {
-                printf("expected argument for option '%s'\n", option->long_identifier);
-            }
-            else
-            {
-                printf("expected argument for option '%c'\n", option->short_identifier);
-            }
-            return 0;
-        }
-        *iptr += 1;
-    }
-    return 1;
+    return cmdoptions_result_mode_get_argument_count_long(options->result, modename, long_identifier);
 }
 
-int cmdoptions_parse(struct cmdoptions* options, int argc, const char* const * argv)
+/* value of a typed once-only option, NULL if neither given nor defaulted (modename NULL: generic option) */
+static const union typed_value* _get_typed(const struct cmdoptions_result* result, const char* modename, const char* long_identifier, int type)
 {
-    int endofoptions = 0;
-    int i;
-    struct mode* mode = _get_basemode(options);
-    for(i = 1; i < argc; ++i)
+    const struct mode* mode = _get_const_basemode(result->options);
+    const struct option* option;
+    if(modename)
     {
-        const char* arg = argv[i];
-        if(!endofoptions && arg[0] == '-' && arg[1] == 0) /* single dash (-) */
-        {
-            /* FIXME: handle single dash */
-        }
-        else if(!endofoptions && arg[0] == '-' && arg[1] == '-' && arg[2] == 0) /* end of options (--) */
-        {
-            endofoptions = 1;
-        }
-        /* special help mode (-h/--help as *first* argument) */
-        else if(!endofoptions &&
-            (
-                (arg[0] == '-' && arg[1] == 'h') ||
-                (arg[0] == '-' && arg[1] == '-' && arg[2] == 'h' && arg[3] == 'e' && arg[4] == 'l' && arg[5] == 'p')
-            ) /* yes, it's ugly, but simple */
-        )
-        {
-            endofoptions = 1; /* causes all subsequent parameters to be parsed as positional parameters */
-            options->help_passed = 1;
-        }
-        else if(!endofoptions && i == 1 && arg[0] != '-') /* mode */
-        {
-            /* FIXME: the current parsing does not support command lines such as:
-             * cmd --generic-option mode --mode-argument 42
-             */
-            mode = _find_mode(options, arg);
-            if(!mode) /* non-existing mode is a parse error */
-            {
-                return 0;
-            }
-            mode->was_selected = 1;
-        }
-        else if(!endofoptions && arg[0] == '-') /* option */
-        {
-            if(arg[1] == '-') /* long option */
-            {
-                const char* longopt = arg + 2;
-                struct option* option = _get_option(mode, 0, longopt);
-                if(!option)
-                {
-                    printf("unknown command line option: '--%s'\n", longopt);
-                    return 0;
-                }
-                else
-                {
-                    if(option->was_provided && !(option->numargs & MULTI_ARGS))
-                    {
-                        printf("option '%s' is only allowed once\n", longopt);
-                    }
-                    if(!_store_argument(option, &i, argc, argv))
-                    {
-                        return 0;
-                    }
-                    /* was_provided is checked in _store_argument, so this has to come after the _store_argument call */
-                    option->was_provided = 1;
-                }
-            }
-            else /* short option */
-            {
-                const char* ch = arg + 1;
-                while(*ch)
-                {
-                    char shortopt = *ch;
-                    struct option* option = _get_option(mode, shortopt, NULL);
-                    if(!option)
-                    {
-                        printf("unknown command line option: '-%c'\n", shortopt);
-                        return 0;
-                    }
-                    else
-                    {
-                        if(option->was_provided && !(option->numargs & MULTI_ARGS))
-                        {
-                            printf("option '%c' is only allowed once\n", shortopt);
-                            return 0;
-                        }
-                        option->was_provided = 1;
-                        if(!_store_argument(option, &i, argc, argv))
-                        {
-                            return 0;
-                        }
-                    }
-                    ++ch;
-                }
-            }
-        }
-        else /* positional parameter */
+        mode = _find_const_mode(result, modename);
+        if(!mode)
         {
-            unsigned int count = 0;
-            char** p = options->positional_parameters;
-            while(*p)
-            {
-                ++count;
-                ++p;
-            }
-            char** positional_parameters = realloc(
-                options->positional_parameters,
-                sizeof(*options->positional_parameters) * (count + 2)); /* one more for the sentinel */
-            if(!positional_parameters)
-            {
-                options->valid = 0;
-                return 0;
-            }
-            options->positional_parameters = positional_parameters;
-            options->positional_parameters[count] = malloc(strlen(arg) + 1);
-            strcpy(options->positional_parameters[count], arg);
-            options->positional_parameters[count + 1] = NULL; /* terminate */
+            fprintf(stderr, "trying to access command-line option '%s' of mode '%s'. This mode does not exist\n", long_identifier, modename);
+            return NULL;
         }
     }
-    return 1;
+    option = _get_const_option(result, mode, 0, long_identifier);
+    if(option && (option->numargs & (ARG_TYPE_MASK | MULTI_ARGS)) != type)
+    {
+        fprintf(stderr, "trying to access command-line option '%s' as once-only option of another type\n", long_identifier);
+        return NULL;
+    }
+    return _get_argument(result, option);
 }
 
-static const void* _get_argument_short(const struct mode* mode, char short_identifier)
+long cmdoptions_result_get_int(const struct cmdoptions_result* result, const char* long_identifier)
 {
-    const struct option* option = _get_const_option(mode, short_identifier, NULL);
-    if(option)
-    {
-        return option->argument;
-    }
-    return NULL;
+    const union typed_value* value = _get_typed(result, NULL, long_identifier, INT_ARG);
+    return value ? value->int_value : 0;
 }
 
-const void* cmdoptions_get_argument_short(struct cmdoptions* options, char short_identifier)
+long cmdoptions_get_int(struct cmdoptions* options, const char* long_identifier)
 {
-    const struct mode* mode = _get_const_basemode(options);
-    return _get_argument_short(mode, short_identifier);
+    return cmdoptions_result_get_int(options->result, long_identifier);
 }
 
-const void* cmdoptions_mode_get_argument_short(struct cmdoptions* options, const char* modename, char short_identifier)
+long cmdoptions_result_mode_get_int(const struct cmdoptions_result* result, const char* modename, const char* long_identifier)
 {
-    const struct mode* mode = _find_const_mode(options, modename);
-    if(!mode)
-    {
-        fprintf(stderr, "trying to access command-line option '%c' of mode '%s'. This mode does not exist\n", short_identifier, modename);
-        return NULL;
-    }
-    return _get_argument_short(mode, short_identifier);
+    const union typed_value* value = _get_typed(result, modename, long_identifier, INT_ARG);
+    return value ? value->int_value : 0;
 }
 
-static const void* _get_argument_long(const struct mode* mode, const char* long_identifier)
+long cmdoptions_mode_get_int(struct cmdoptions* options, const char* modename, const char* long_identifier)
 {
-    const struct option* option = _get_const_option(mode, 0, long_identifier);
-    if(option)
-    {
-        return option->argument;
-    }
-    return NULL;
+    return cmdoptions_result_mode_get_int(options->result, modename, long_identifier);
 }
 
-const void* cmdoptions_get_argument_long(struct cmdoptions* options, const char* long_identifier)
+unsigned long cmdoptions_result_get_uint(const struct cmdoptions_result* result, const char* long_identifier)
 {
-    const struct mode* mode = _get_const_basemode(options);
-    return _get_argument_long(mode, long_identifier);
+    const union typed_value* value = _get_typed(result, NULL, long_identifier, UINT_ARG);
+    return value ? value->uint_value : 0;
 }
 
-const void* cmdoptions_mode_get_argument_long(struct cmdoptions* options, const char* modename, const char* long_identifier)
+unsigned long cmdoptions_get_uint(struct cmdoptions* options, const char* long_identifier)
 {
-    const struct mode* mode = _find_const_mode(options, modename);
-    if(!mode)
-    {
-        fprintf(stderr, "trying to access command-line option '%s' of mode '%s'. This mode does not exist\n", long_identifier, modename);
-        return NULL;
-    }
-    return _get_argument_long(mode, long_identifier);
+    return cmdoptions_result_get_uint(options->result, long_identifier);
+}
+
+unsigned long cmdoptions_result_mode_get_uint(const struct cmdoptions_result* result, const char* modename, const char* long_identifier)
+{
+    const union typed_value* value = _get_typed(result, modename, long_identifier, UINT_ARG);
+    return value ? value->uint_value : 0;
+}
+
+unsigned long cmdoptions_mode_get_uint(struct cmdoptions* options, const char* modename, const char* long_identifier)
+{
+    return cmdoptions_result_mode_get_uint(options->result, modename, long_identifier);
+}
+
+double cmdoptions_result_get_double(const struct cmdoptions_result* result, const char* long_identifier)
+{
+    const union typed_value* value = _get_typed(result, NULL, long_identifier, DOUBLE_ARG);
+    return value ? value->double_value : 0;
+}
+
+double cmdoptions_get_double(struct cmdoptions* options, const char* long_identifier)
+{
+    return cmdoptions_result_get_double(options->result, long_identifier);
+}
+
+double cmdoptions_result_mode_get_double(const struct cmdoptions_result* result, const char* modename, const char* long_identifier)
+{
+    const union typed_value* value = _get_typed(result, modename, long_identifier, DOUBLE_ARG);
+    return value ? value->double_value : 0;
+}
+
+double cmdoptions_mode_get_double(struct cmdoptions* options, const char* modename, const char* long_identifier)
+{
+    return cmdoptions_result_mode_get_double(options->result, modename, long_identifier);
+}
+
+int cmdoptions_result_get_bool(const struct cmdoptions_result* result, const char* long_identifier)
+{
+    const union typed_value* value = _get_typed(result, NULL, long_identifier, BOOL_ARG);
+    return value ? value->bool_value : 0;
 }
 
+int cmdoptions_get_bool(struct cmdoptions* options, const char* long_identifier)
+{
+    return cmdoptions_result_get_bool(options->result, long_identifier);
+}
+
+int cmdoptions_result_mode_get_bool(const struct cmdoptions_result* result, const char* modename, const char* long_identifier)
+{
+    const union typed_value* value = _get_typed(result, modename, long_identifier, BOOL_ARG);
+    return value ? value->bool_value : 0;
+}
+
+int cmdoptions_mode_get_bool(struct cmdoptions* options, const char* modename, const char* long_identifier)
+{
+    return cmdoptions_result_mode_get_bool(options->result, modename, long_identifier);
+}
+
+size_t cmdoptions_result_get_size(const struct cmdoptions_result* result, const char* long_identifier)
+{
+    const union typed_value* value = _get_typed(result, NULL, long_identifier, SIZE_ARG);
+    return value ? value->size_value : 0;
+}
+
+size_t cmdoptions_get_size(struct cmdoptions* options, const char* long_identifier)
+{
+    return cmdoptions_result_get_size(options->result, long_identifier);
+}
+
+size_t cmdoptions_result_mode_get_size(const struct cmdoptions_result* result, const char* modename, const char* long_identifier)
+{
+    const union typed_value* value = _get_typed(result, modename, long_identifier, SIZE_ARG);
+    return value ? value->size_value : 0;
+}
+
+size_t cmdoptions_mode_get_size(struct cmdoptions* options, const char* modename, const char* long_identifier)
+{
+    return cmdoptions_result_mode_get_size(options->result, modename, long_identifier);
+}
+
+double cmdoptions_result_get_duration(const struct cmdoptions_result* result, const char* long_identifier)
+{
+    const union typed_value* value = _get_typed(result, NULL, long_identifier, DURATION_ARG);
+    return value ? value->double_value : 0;
+}
+
+double cmdoptions_get_duration(struct cmdoptions* options, const char* long_identifier)
+{
+    return cmdoptions_result_get_duration(options->result, long_identifier);
+}
+
+double cmdoptions_result_mode_get_duration(const struct cmdoptions_result* result, const char* modename, const char* long_identifier)
+{
+    const union typed_value* value = _get_typed(result, modename, long_identifier, DURATION_ARG);
+    return value ? value->double_value : 0;
+}
+
+double cmdoptions_mode_get_duration(struct cmdoptions* options, const char* modename, const char* long_identifier)
+{
+    return cmdoptions_result_mode_get_duration(options->result, modename, long_identifier);
+}
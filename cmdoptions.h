@@ -1,11 +1,26 @@
 #ifndef OPC_CMDOPTS_H
 #define OPC_CMDOPTS_H
 
+#include <stddef.h>
+
 /* arguments */
 #define NO_ARG 0
 #define SINGLE_ARG 1
 #define MULTI_ARGS 2
 
+/*
+ * argument types, or'ed with SINGLE_ARG or MULTI_ARGS (arguments are strings otherwise)
+ * the arguments are converted while parsing, cmdoptions_get_argument_* then returns a pointer to the value or to an array of values
+ * (the default of a multiple option that was not given is an array of one value)
+ */
+#define INT_ARG 0x10 /* long */
+#define UINT_ARG 0x20 /* unsigned long */
+#define DOUBLE_ARG 0x30 /* double */
+#define BOOL_ARG 0x40 /* int, from true/false, yes/no, on/off or 1/0 */
+#define SIZE_ARG 0x50 /* size_t, with an optional suffix K, M, G or T (powers of 1024) */
+#define DURATION_ARG 0x60 /* double seconds, from a sequence of numbers with units (ns, us, ms, s, m, h, d), e.g. 1h30m */
+#define ARG_TYPE_MASK 0xf0
+
 /* short and long options */
 #define NO_SHORT 0
 #define NO_LONG NULL
@@ -13,17 +28,150 @@
 /* main public structure */
 struct cmdoptions;
 
+/* state of one parse against a frozen structure, see cmdoptions_freeze */
+struct cmdoptions_result;
+
+/* output sink, see print.h */
+struct print_sink;
+
+/* memory allocation hooks, every allocation of a struct cmdoptions goes through these */
+struct cmdoptions_allocator {
+    void* (*allocate)(void* context, size_t size);
+    void* (*reallocate)(void* context, void* ptr, size_t size);
+    void (*deallocate)(void* context, void* ptr);
+    void* context;
+};
+
+/* events reported by cmdoptions_parse_events */
+#define CMDOPTIONS_EVENT_OPTION 1
+#define CMDOPTIONS_EVENT_POSITIONAL 2
+#define CMDOPTIONS_EVENT_MODE 3
+#define CMDOPTIONS_EVENT_ERROR 4
+
+struct cmdoptions_event {
+    int type;
+    const char* modename; /* selected mode, NULL for generic options */
+    char short_identifier; /* option (aliases are resolved) */
+    const char* long_identifier;
+    int numargs;
+    const char* value; /* argument, positional parameter or offending token, only valid during the callback */
+    const void* typed_value; /* converted argument of typed options (e.g. const long*), NULL otherwise, only valid during the callback */
+    const char* error; /* error message */
+};
+
+/* static option tables, generated by cmdoptions_export_static_table */
+#define CMDOPTIONS_STATIC_OPTION 1
+#define CMDOPTIONS_STATIC_SECTION 2
+
+struct cmdoptions_static_entry {
+    int what;
+    char short_identifier;
+    const char* long_identifier; /* name for sections */
+    int numargs;
+    const char* default_argument;
+    const char* help;
+    int aliased; /* index of the aliased entry or -1 */
+    int checked; /* exempt from cmdoptions_assert_all_options_checked */
+};
+
+/* perfect hash: the key can only be in slots[hash(key, seeds[hash(key, 0) % seeds_size]) % slots_size] */
+struct cmdoptions_static_hash {
+    const unsigned long* seeds;
+    size_t seeds_size;
+    const int* slots; /* entry/mode index or -1 */
+    size_t slots_size;
+};
+
+struct cmdoptions_static_mode {
+    const char* identifier; /* NULL for generic options */
+    const struct cmdoptions_static_entry* entries;
+    size_t size;
+    size_t first_entry; /* option ID of the first entry */
+    const int* short_table; /* 256 entry indices (or -1) */
+    struct cmdoptions_static_hash long_hash;
+};
+
+/* complete help message, rendered at build time for one display width and layout */
+struct cmdoptions_static_help {
+    unsigned int width;
+    int narrow;
+    const char* text;
+    size_t length;
+};
+
+struct cmdoptions_static_table {
+    const struct cmdoptions_static_mode* modes;
+    size_t size;
+    struct cmdoptions_static_hash mode_hash;
+    size_t entries; /* of all modes */
+    const char* prehelpmsg;
+    const char* posthelpmsg;
+    const struct cmdoptions_static_help* help; /* may be NULL, other widths are laid out at runtime */
+    size_t help_size;
+    const char* manpage; /* option part of the manpage, may be NULL */
+};
+
+/* counters of a struct cmdoptions or a result, only collected if compiled with CMDOPTIONS_ENABLE_STATS (times are processor time in seconds) */
+struct cmdoptions_stats {
+    unsigned long definitions; /* options, aliases, sections and modes added */
+    double definition_time;
+    unsigned long parses;
+    double parse_time;
+    unsigned long lookups; /* options and modes looked up by identifier */
+    unsigned long lookup_hits;
+    unsigned long lookup_misses;
+    unsigned long entries_scanned; /* index slots and table entries compared during lookups */
+    unsigned long help_renders;
+    double help_time;
+    unsigned long allocations;
+    size_t bytes_allocated; /* in total */
+    size_t heap_size; /* currently allocated */
+    size_t peak_heap_size;
+};
+
 /* initialization and clean-up */
 struct cmdoptions* cmdoptions_create(void);
+struct cmdoptions* cmdoptions_create_with_arena(void);
+struct cmdoptions* cmdoptions_create_with_allocator(const struct cmdoptions_allocator* allocator);
+struct cmdoptions* cmdoptions_create_with_storage(void* storage, size_t size);
+struct cmdoptions* cmdoptions_create_static(const struct cmdoptions_static_table* table);
+struct cmdoptions* cmdoptions_load_snapshot(const char* path);
+int cmdoptions_save_snapshot(const struct cmdoptions* options, const char* path);
+size_t cmdoptions_get_storage_used(const struct cmdoptions* options);
 void cmdoptions_enable_narrow_mode(struct cmdoptions* options);
 void cmdoptions_disable_narrow_mode(struct cmdoptions* options);
+void cmdoptions_enable_borrowed_arguments(struct cmdoptions* options);
+void cmdoptions_disable_borrowed_arguments(struct cmdoptions* options);
+void cmdoptions_enable_response_files(struct cmdoptions* options);
+void cmdoptions_disable_response_files(struct cmdoptions* options);
+void cmdoptions_enable_static_strings(struct cmdoptions* options);
+void cmdoptions_disable_static_strings(struct cmdoptions* options);
 void cmdoptions_destroy(struct cmdoptions* options);
 void cmdoptions_exit(struct cmdoptions* options, int exitcode);
 int cmdoptions_is_valid(const struct cmdoptions* options);
 int cmdoptions_assert_all_options_checked(const struct cmdoptions* options);
+int cmdoptions_get_stats(const struct cmdoptions* options, struct cmdoptions_stats* stats);
 
 /* parsing */
 int cmdoptions_parse(struct cmdoptions* options, int argc, const char* const * argv);
+int cmdoptions_parse_string(struct cmdoptions* options, char* str);
+int cmdoptions_parse_events(struct cmdoptions* options, int argc, const char* const * argv, int (*callback)(const struct cmdoptions_event* event, void* userdata), void* userdata);
+void cmdoptions_reset(struct cmdoptions* options);
+
+/* parsing against a shared, frozen definition */
+void cmdoptions_freeze(struct cmdoptions* options);
+struct cmdoptions_result* cmdoptions_result_create(const struct cmdoptions* options);
+void cmdoptions_result_destroy(struct cmdoptions_result* result);
+int cmdoptions_result_is_valid(const struct cmdoptions_result* result);
+int cmdoptions_result_get_stats(const struct cmdoptions_result* result, struct cmdoptions_stats* stats);
+int cmdoptions_result_parse(struct cmdoptions_result* result, int argc, const char* const * argv);
+int cmdoptions_result_parse_string(struct cmdoptions_result* result, char* str);
+void cmdoptions_result_reset(struct cmdoptions_result* result);
+
+/* parsing a file with one command line per line, see README.md */
+#define CMDOPTIONS_BATCH_ORDERED 1 /* call the callback in the order of the lines, one line at a time */
+#define CMDOPTIONS_BATCH_STOPPED 2 /* returned (instead of 1) if the callback stopped the batch, 0 is returned on errors */
+int cmdoptions_parse_batch(const struct cmdoptions* options, const char* path, unsigned int threads, int flags, int (*callback)(struct cmdoptions_result* result, size_t line, int parsed, void* userdata), void* userdata);
 
 /* defining options and sections */
 int cmdoptions_add_mode(struct cmdoptions* options, const char* modename);
@@ -40,7 +188,11 @@ void cmdoptions_append_help_message(struct cmdoptions* options, const char* msg)
 
 /* help display */
 int cmdoptions_help(const struct cmdoptions* options);
+int cmdoptions_help_sink(const struct cmdoptions* options, struct print_sink* sink);
 void cmdoptions_export_manpage(const struct cmdoptions* options);
+void cmdoptions_export_manpage_sink(const struct cmdoptions* options, struct print_sink* sink);
+int cmdoptions_export_static_table(const struct cmdoptions* options, const char* name);
+int cmdoptions_export_static_header(const struct cmdoptions* options, const char* name);
 
 /* query option info */
 int cmdoptions_help_passed(struct cmdoptions* options);
@@ -51,13 +203,69 @@ int cmdoptions_was_provided_short(struct cmdoptions* options, char short_identif
 int cmdoptions_mode_was_provided_short(struct cmdoptions* options, const char* modename, char short_identifier);
 int cmdoptions_was_provided_long(struct cmdoptions* options, const char* long_identifier);
 int cmdoptions_mode_was_provided_long(struct cmdoptions* options, const char* modename, const char* long_identifier);
+int cmdoptions_was_provided_id(struct cmdoptions* options, int id);
 
 /* query option content */
 const void* cmdoptions_get_argument_short(struct cmdoptions* options, char short_identifier);
 const void* cmdoptions_mode_get_argument_short(struct cmdoptions* options, const char* modename, char short_identifier);
 const void* cmdoptions_get_argument_long(struct cmdoptions* options, const char* long_identifier);
 const void* cmdoptions_mode_get_argument_long(struct cmdoptions* options, const char* modename, const char* long_identifier);
+const void* cmdoptions_get_argument_id(struct cmdoptions* options, int id);
+size_t cmdoptions_get_argument_count_short(struct cmdoptions* options, char short_identifier);
+size_t cmdoptions_mode_get_argument_count_short(struct cmdoptions* options, const char* modename, char short_identifier);
+size_t cmdoptions_get_argument_count_long(struct cmdoptions* options, const char* long_identifier);
+size_t cmdoptions_mode_get_argument_count_long(struct cmdoptions* options, const char* modename, const char* long_identifier);
 const char** cmdoptions_get_positional_parameters(const struct cmdoptions* options);
+size_t cmdoptions_get_positional_count(const struct cmdoptions* options);
+const char* cmdoptions_get_positional_parameter(const struct cmdoptions* options, size_t index);
+
+/* values of typed SINGLE_ARG options (0 if neither given nor defaulted) */
+long cmdoptions_get_int(struct cmdoptions* options, const char* long_identifier);
+long cmdoptions_mode_get_int(struct cmdoptions* options, const char* modename, const char* long_identifier);
+unsigned long cmdoptions_get_uint(struct cmdoptions* options, const char* long_identifier);
+unsigned long cmdoptions_mode_get_uint(struct cmdoptions* options, const char* modename, const char* long_identifier);
+double cmdoptions_get_double(struct cmdoptions* options, const char* long_identifier);
+double cmdoptions_mode_get_double(struct cmdoptions* options, const char* modename, const char* long_identifier);
+int cmdoptions_get_bool(struct cmdoptions* options, const char* long_identifier);
+int cmdoptions_mode_get_bool(struct cmdoptions* options, const char* modename, const char* long_identifier);
+size_t cmdoptions_get_size(struct cmdoptions* options, const char* long_identifier);
+size_t cmdoptions_mode_get_size(struct cmdoptions* options, const char* modename, const char* long_identifier);
+double cmdoptions_get_duration(struct cmdoptions* options, const char* long_identifier);
+double cmdoptions_mode_get_duration(struct cmdoptions* options, const char* modename, const char* long_identifier);
+
+/* querying a result, these work like the functions above */
+int cmdoptions_result_help_passed(const struct cmdoptions_result* result);
+int cmdoptions_result_no_args_given(const struct cmdoptions_result* result);
+int cmdoptions_result_mode_no_args_given(const struct cmdoptions_result* result, const char* modename);
+int cmdoptions_result_was_provided_short(struct cmdoptions_result* result, char short_identifier);
+int cmdoptions_result_mode_was_provided_short(struct cmdoptions_result* result, const char* modename, char short_identifier);
+int cmdoptions_result_was_provided_long(struct cmdoptions_result* result, const char* long_identifier);
+int cmdoptions_result_mode_was_provided_long(struct cmdoptions_result* result, const char* modename, const char* long_identifier);
+int cmdoptions_result_was_provided_id(struct cmdoptions_result* result, int id);
+const void* cmdoptions_result_get_argument_short(const struct cmdoptions_result* result, char short_identifier);
+const void* cmdoptions_result_mode_get_argument_short(const struct cmdoptions_result* result, const char* modename, char short_identifier);
+const void* cmdoptions_result_get_argument_long(const struct cmdoptions_result* result, const char* long_identifier);
+const void* cmdoptions_result_mode_get_argument_long(const struct cmdoptions_result* result, const char* modename, const char* long_identifier);
+const void* cmdoptions_result_get_argument_id(const struct cmdoptions_result* result, int id);
+size_t cmdoptions_result_get_argument_count_short(const struct cmdoptions_result* result, char short_identifier);
+size_t cmdoptions_result_mode_get_argument_count_short(const struct cmdoptions_result* result, const char* modename, char short_identifier);
+size_t cmdoptions_result_get_argument_count_long(const struct cmdoptions_result* result, const char* long_identifier);
+size_t cmdoptions_result_mode_get_argument_count_long(const struct cmdoptions_result* result, const char* modename, const char* long_identifier);
+const char** cmdoptions_result_get_positional_parameters(const struct cmdoptions_result* result);
+size_t cmdoptions_result_get_positional_count(const struct cmdoptions_result* result);
+const char* cmdoptions_result_get_positional_parameter(const struct cmdoptions_result* result, size_t index);
+long cmdoptions_result_get_int(const struct cmdoptions_result* result, const char* long_identifier);
+long cmdoptions_result_mode_get_int(const struct cmdoptions_result* result, const char* modename, const char* long_identifier);
+unsigned long cmdoptions_result_get_uint(const struct cmdoptions_result* result, const char* long_identifier);
+unsigned long cmdoptions_result_mode_get_uint(const struct cmdoptions_result* result, const char* modename, const char* long_identifier);
+double cmdoptions_result_get_double(const struct cmdoptions_result* result, const char* long_identifier);
+double cmdoptions_result_mode_get_double(const struct cmdoptions_result* result, const char* modename, const char* long_identifier);
+int cmdoptions_result_get_bool(const struct cmdoptions_result* result, const char* long_identifier);
+int cmdoptions_result_mode_get_bool(const struct cmdoptions_result* result, const char* modename, const char* long_identifier);
+size_t cmdoptions_result_get_size(const struct cmdoptions_result* result, const char* long_identifier);
+size_t cmdoptions_result_mode_get_size(const struct cmdoptions_result* result, const char* modename, const char* long_identifier);
+double cmdoptions_result_get_duration(const struct cmdoptions_result* result, const char* long_identifier);
+double cmdoptions_result_mode_get_duration(const struct cmdoptions_result* result, const char* modename, const char* long_identifier);
 
 #endif /* OPC_CMDOPTS_H */
 
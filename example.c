@@ -39,8 +39,8 @@ int main(int argc, const char * const *argv)
     /* option with argument */
     if(cmdoptions_mode_was_provided_long(cmdoptions, "create", "number"))
     {
-        int num = atoi(cmdoptions_mode_get_argument_long(cmdoptions, "create", "number"));
-        printf("number was: %d\n", num);
+        long num = cmdoptions_mode_get_int(cmdoptions, "create", "number"); /* converted and checked while parsing */
+        printf("number was: %ld\n", num);
     }
 
     /*
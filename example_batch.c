@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cmdoptions.h"
+
+/* called for every non-empty line of the job file, in the order of the file */
+static int report_line(struct cmdoptions_result* result, size_t line, int parsed, void* userdata)
+{
+    const char** pos;
+    unsigned long* failed = userdata;
+    if(!parsed)
+    {
+        printf("line %lu: parsing failed\n", (unsigned long)line);
+        *failed += 1; /* no locking needed, ordered callbacks are never called concurrently */
+        return 1;
+    }
+    printf("line %lu:", (unsigned long)line);
+    if(cmdoptions_result_help_passed(result))
+    {
+        printf(" help");
+    }
+    if(cmdoptions_result_was_provided_long(result, "xoption"))
+    {
+        printf(" xoption");
+    }
+    if(cmdoptions_result_mode_was_provided_long(result, "create", "number"))
+    {
+        printf(" number %ld", cmdoptions_result_mode_get_int(result, "create", "number"));
+    }
+    pos = cmdoptions_result_get_positional_parameters(result);
+    while(*pos)
+    {
+        printf(" '%s'", *pos);
+        ++pos;
+    }
+    printf("\n");
+    return 1; /* 0 would stop the batch */
+}
+
+/* parses every line of a job file as a command line of example.c, with one worker per processor unless a number is given */
+int main(int argc, const char * const *argv)
+{
+    int returnvalue;
+    unsigned long failed;
+
+    if(argc < 2)
+    {
+        fprintf(stderr, "usage: %s JOBFILE [THREADS]\n", argv[0]);
+        return 1;
+    }
+
+    /* create state and add options, then share it between the workers */
+    {
+        struct cmdoptions* cmdoptions = cmdoptions_create();
+        #include "cmdoptions_def.c"
+        cmdoptions_enable_borrowed_arguments(cmdoptions); /* arguments point into the job file */
+        cmdoptions_freeze(cmdoptions);
+        if(!cmdoptions_is_valid(cmdoptions))
+        {
+            fprintf(stderr, "%s\n", "initialization of command-line options parser failed");
+            cmdoptions_exit(cmdoptions, 1);
+        }
+
+        /* parse all lines */
+        returnvalue = 0;
+        failed = 0;
+        if(!cmdoptions_parse_batch(cmdoptions, argv[1], argc > 2 ? (unsigned int)atoi(argv[2]) : 0, CMDOPTIONS_BATCH_ORDERED, report_line, &failed))
+        {
+            returnvalue = 1;
+            fprintf(stderr, "%s\n", "parsing of the job file failed");
+        }
+        else if(failed > 0)
+        {
+            returnvalue = 1;
+            fprintf(stderr, "parsing of %lu lines failed\n", failed);
+        }
+
+        cmdoptions_destroy(cmdoptions);
+    }
+    return returnvalue;
+}
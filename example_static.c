@@ -0,0 +1,62 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cmdoptions.h"
+#include "example_table.h"
+
+/* same as example.c, but the options are taken from the table generated by generate_static_table */
+int main(int argc, const char * const *argv)
+{
+    int returnvalue;
+    const char** pos;
+    unsigned int count;
+
+    /* create state from the generated table */
+    struct cmdoptions* cmdoptions = cmdoptions_create_static(&example_table);
+    if(!cmdoptions)
+    {
+        fprintf(stderr, "%s\n", "initialization of command-line options parser failed");
+        return 1;
+    }
+
+    /* parse options */
+    returnvalue = 0;
+    if(!cmdoptions_parse(cmdoptions, argc, argv))
+    {
+        returnvalue = 1;
+        fprintf(stderr, "%s\n", "parsing of command-line options failed");
+        goto DESTROY_CMDOPTIONS;
+    }
+
+    /* test for options */
+    if(cmdoptions_help_passed(cmdoptions))
+    {
+        cmdoptions_help(cmdoptions); /* display help message */
+        goto DESTROY_CMDOPTIONS;
+    }
+
+    /* option with argument, looked up by ID */
+    if(cmdoptions_was_provided_id(cmdoptions, EXAMPLE_CREATE_NUMBER))
+    {
+        long num = *(const long*)cmdoptions_get_argument_id(cmdoptions, EXAMPLE_CREATE_NUMBER); /* INT_ARG option */
+        printf("number was: %ld\n", num);
+    }
+
+    cmdoptions_was_provided_id(cmdoptions, EXAMPLE_XOPTION);
+
+    /* check that no options stay unprocessed */
+    cmdoptions_assert_all_options_checked(cmdoptions);
+
+    pos = cmdoptions_get_positional_parameters(cmdoptions);
+    count = 1;
+    while(*pos)
+    {
+        printf("positional parameter #%d: %s\n", count, *pos);
+        ++count;
+        ++pos;
+    }
+
+DESTROY_CMDOPTIONS:
+    cmdoptions_destroy(cmdoptions);
+    return returnvalue;
+}
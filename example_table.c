@@ -0,0 +1,192 @@
+/* generated by cmdoptions_export_static_table, do not edit */
+#include "cmdoptions.h"
+
+static const struct cmdoptions_static_entry example_entries_0[] = {
+    { CMDOPTIONS_STATIC_OPTION, 'h', "help", 0, NULL, "display help", -1, 1 },
+    { CMDOPTIONS_STATIC_OPTION, 'x', "xoption", 0, NULL, "test option", -1, 0 }
+};
+static const int example_short_0[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, 0, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, 1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+static const unsigned long example_long_seeds_0[] = {
+    1UL, 0UL
+};
+static const int example_long_slots_0[] = {
+    -1, 1, 0
+};
+
+static const struct cmdoptions_static_entry example_entries_1[] = {
+    { CMDOPTIONS_STATIC_OPTION, 'n', "number", 17, NULL, "number", -1, 0 }
+};
+static const int example_short_1[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+static const unsigned long example_long_seeds_1[] = {
+    1UL
+};
+static const int example_long_slots_1[] = {
+    -1, 0
+};
+
+static const unsigned long example_mode_seeds_0[] = {
+    1UL
+};
+static const int example_mode_slots_0[] = {
+    -1, 1
+};
+
+static const struct cmdoptions_static_mode example_modes[] = {
+    { NULL, example_entries_0, 2, 0, example_short_0, { example_long_seeds_0, 2, example_long_slots_0, 3 } },
+    { "create", example_entries_1, 1, 2, example_short_1, { example_long_seeds_1, 1, example_long_slots_1, 2 } }
+};
+
+static const struct cmdoptions_static_help example_help[] = {
+    { 80, 1,
+        "*** Beginning of help message ***\n"
+        "list of command line options:\n"
+        "\n"
+        "generic options:\n"
+        "    -h,--help\n"
+        "        display help\n"
+        "    -x,--xoption\n"
+        "        test option\n"
+        "\n"
+        "create:\n"
+        "    -n,--number\n"
+        "        number\n"
+        "\n"
+        "*** End of help message ***\n",
+        223 },
+    { 100, 1,
+        "*** Beginning of help message ***\n"
+        "list of command line options:\n"
+        "\n"
+        "generic options:\n"
+        "    -h,--help\n"
+        "        display help\n"
+        "    -x,--xoption\n"
+        "        test option\n"
+        "\n"
+        "create:\n"
+        "    -n,--number\n"
+        "        number\n"
+        "\n"
+        "*** End of help message ***\n",
+        223 },
+    { 100, 0,
+        "*** Beginning of help message ***\n"
+        "list of command line options:\n"
+        "\n"
+        "generic options:\n"
+        "    -h,--help       display help\n"
+        "    -x,--xoption    test option\n"
+        "\n"
+        "create:\n"
+        "    -n,--number     number\n"
+        "\n"
+        "*** End of help message ***\n",
+        212 },
+    { 120, 1,
+        "*** Beginning of help message ***\n"
+        "list of command line options:\n"
+        "\n"
+        "generic options:\n"
+        "    -h,--help\n"
+        "        display help\n"
+        "    -x,--xoption\n"
+        "        test option\n"
+        "\n"
+        "create:\n"
+        "    -n,--number\n"
+        "        number\n"
+        "\n"
+        "*** End of help message ***\n",
+        223 },
+    { 120, 0,
+        "*** Beginning of help message ***\n"
+        "list of command line options:\n"
+        "\n"
+        "generic options:\n"
+        "    -h,--help       display help\n"
+        "    -x,--xoption    test option\n"
+        "\n"
+        "create:\n"
+        "    -n,--number     number\n"
+        "\n"
+        "*** End of help message ***\n",
+        212 },
+    { 160, 1,
+        "*** Beginning of help message ***\n"
+        "list of command line options:\n"
+        "\n"
+        "generic options:\n"
+        "    -h,--help\n"
+        "        display help\n"
+        "    -x,--xoption\n"
+        "        test option\n"
+        "\n"
+        "create:\n"
+        "    -n,--number\n"
+        "        number\n"
+        "\n"
+        "*** End of help message ***\n",
+        223 },
+    { 160, 0,
+        "*** Beginning of help message ***\n"
+        "list of command line options:\n"
+        "\n"
+        "generic options:\n"
+        "    -h,--help       display help\n"
+        "    -x,--xoption    test option\n"
+        "\n"
+        "create:\n"
+        "    -n,--number     number\n"
+        "\n"
+        "*** End of help message ***\n",
+        212 }
+};
+
+static const char example_manpage[] =
+    ".IP \"\\fB\\-h,--help\\fR \" 4\n"
+    "display help\n"
+    ".IP \"\\fB\\-x,--xoption\\fR \" 4\n"
+    "test option\n"
+    ".IP \"\\fB\\-n,--number\\fR \" 4\n"
+    "number\n";
+
+const struct cmdoptions_static_table example_table = {
+    example_modes, 2, { example_mode_seeds_0, 1, example_mode_slots_0, 2 }, 3,
+    "*** Beginning of help message ***",
+    "*** End of help message ***",
+    example_help, 7, example_manpage
+};
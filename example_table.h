@@ -0,0 +1,17 @@
+/* generated by cmdoptions_export_static_header, do not edit */
+#ifndef EXAMPLE_TABLE_H
+#define EXAMPLE_TABLE_H
+
+#include "cmdoptions.h"
+
+/* option IDs for cmdoptions_was_provided_id and cmdoptions_get_argument_id */
+enum example_option {
+    EXAMPLE_HELP = 0,
+    EXAMPLE_XOPTION = 1,
+    EXAMPLE_CREATE_NUMBER = 2,
+    EXAMPLE_NUMBER_OF_IDS = 3
+};
+
+extern const struct cmdoptions_static_table example_table;
+
+#endif
@@ -1,119 +1,488 @@
-#include <ctype.h>
+#ifdef CMDOPTIONS_ENABLE_TERM_WIDTH
+#define _DEFAULT_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "print.h"
+
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-#ifdef TERMOGRAPHY_ENABLE_TERM_WIDTH
+#ifdef CMDOPTIONS_ENABLE_TERM_WIDTH
 #include <sys/ioctl.h>
-#include <err.h>
-#include <fcntl.h>
+#include <signal.h>
 #include <unistd.h>
-#include <termios.h>
 #endif
 
-unsigned int print_get_screen_width(void)
+static void* _default_reallocate(void* context, void* ptr, size_t size)
+{
+    (void)context;
+    return realloc(ptr, size);
+}
+
+static void _default_deallocate(void* context, void* ptr)
+{
+    (void)context;
+    free(ptr);
+}
+
+static void _init_sink(struct print_sink* sink)
+{
+    sink->data = NULL;
+    sink->size = 0;
+    sink->capacity = 0;
+    sink->file = NULL;
+    sink->callback = NULL;
+    sink->userdata = NULL;
+    sink->reallocate = _default_reallocate;
+    sink->deallocate = _default_deallocate;
+    sink->context = NULL;
+    sink->valid = 1;
+}
+
+void print_sink_init_file(struct print_sink* sink, FILE* file)
+{
+    _init_sink(sink);
+    sink->file = file;
+}
+
+void print_sink_init_buffer(struct print_sink* sink)
+{
+    _init_sink(sink);
+}
+
+void print_sink_init_callback(struct print_sink* sink, void (*callback)(void* userdata, const char* data, size_t size), void* userdata)
+{
+    _init_sink(sink);
+    sink->callback = callback;
+    sink->userdata = userdata;
+}
+
+void print_sink_set_allocator(struct print_sink* sink, void* (*reallocate)(void* context, void* ptr, size_t size), void (*deallocate)(void* context, void* ptr), void* context)
+{
+    sink->reallocate = reallocate;
+    sink->deallocate = deallocate;
+    sink->context = context;
+}
+
+static void _pass_on(struct print_sink* sink, const char* data, size_t size)
+{
+    if(sink->file)
+    {
+        fwrite(data, 1, size, sink->file);
+    }
+    else if(sink->callback)
+    {
+        sink->callback(sink->userdata, data, size);
+    }
+}
+
+void print_sink_write(struct print_sink* sink, const char* data, size_t size)
+{
+    size_t capacity = sink->capacity;
+    char* new;
+    while(sink->size + size + 1 > capacity) /* +1: terminator */
+    {
+        capacity = capacity ? 2 * capacity : 4096;
+    }
+    if(capacity != sink->capacity)
+    {
+        new = sink->reallocate(sink->context, sink->data, capacity);
+        if(!new)
+        {
+            /* without memory, sinks with a target write through */
+            if(sink->file || sink->callback)
+            {
+                print_sink_flush(sink);
+                _pass_on(sink, data, size);
+            }
+            else
+            {
+                sink->valid = 0;
+            }
+            return;
+        }
+        sink->data = new;
+        sink->capacity = capacity;
+    }
+    memcpy(sink->data + sink->size, data, size);
+    sink->size += size;
+    sink->data[sink->size] = 0;
+}
+
+void print_sink_putc(struct print_sink* sink, char ch)
 {
-#ifdef TERMOGRAPHY_ENABLE_TERM_WIDTH
+    if(sink->size + 2 <= sink->capacity) /* fast path, +1: terminator */
+    {
+        sink->data[sink->size] = ch;
+        sink->size += 1;
+        sink->data[sink->size] = 0;
+        return;
+    }
+    print_sink_write(sink, &ch, 1);
+}
+
+void print_sink_puts(struct print_sink* sink, const char* str)
+{
+    print_sink_write(sink, str, strlen(str));
+}
+
+void print_sink_spaces(struct print_sink* sink, unsigned int num)
+{
+    unsigned int i;
+    for(i = 0; i < num; ++i)
+    {
+        print_sink_putc(sink, ' ');
+    }
+}
+
+/* passes the buffered output on in one piece, buffer sinks keep their content */
+int print_sink_flush(struct print_sink* sink)
+{
+    if(!sink->file && !sink->callback)
+    {
+        return sink->valid;
+    }
+    if(sink->size)
+    {
+        _pass_on(sink, sink->data, sink->size);
+        sink->size = 0;
+        sink->data[0] = 0;
+    }
+    if(sink->file)
+    {
+        return fflush(sink->file) == 0;
+    }
+    return 1;
+}
+
+void print_sink_release(struct print_sink* sink)
+{
+    if(sink->data)
+    {
+        sink->deallocate(sink->context, sink->data);
+    }
+    sink->data = NULL;
+    sink->size = 0;
+    sink->capacity = 0;
+}
+
+/* the width is determined once per process (and again after a SIGWINCH if resize tracking is enabled) */
+static unsigned int _screen_width = 0;
+static unsigned int _injected_width = 0;
+#ifdef CMDOPTIONS_ENABLE_TERM_WIDTH
+static volatile sig_atomic_t _screen_resized = 0;
+
+static void _handle_resize(int signum)
+{
+    (void)signum;
+    _screen_resized = 1;
+}
+#endif
+
+static unsigned int _query_screen_width(void)
+{
+    const char* columns;
+    long width;
+#ifdef CMDOPTIONS_ENABLE_TERM_WIDTH
     struct winsize ws;
-    int fd;
+    /* ask the standard descriptors, without opening the terminal */
+    if(ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0)
+    {
+        return ws.ws_col;
+    }
+    if(ioctl(STDERR_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0)
+    {
+        return ws.ws_col;
+    }
+    if(ioctl(STDIN_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0)
+    {
+        return ws.ws_col;
+    }
+#endif
+    columns = getenv("COLUMNS");
+    if(columns)
+    {
+        width = strtol(columns, NULL, 10);
+        if(width > 0 && width < 10000)
+        {
+            return width;
+        }
+    }
+    return 80; /* fall back to 80 in case of errors */
+}
 
-    fd = open("/dev/tty", O_RDWR);
-    if(fd < 0 || ioctl(fd, TIOCGWINSZ, &ws) < 0)
+unsigned int print_get_screen_width(void)
+{
+    if(_injected_width)
+    {
+        return _injected_width;
+    }
+#ifdef CMDOPTIONS_ENABLE_TERM_WIDTH
+    if(_screen_resized)
     {
-        return 80; /* fall back to 80 in case of errors */
+        _screen_resized = 0;
+        _screen_width = 0;
     }
+#endif
+    if(!_screen_width)
+    {
+        _screen_width = _query_screen_width();
+    }
+    return _screen_width;
+}
 
-    close(fd);
+/* 0 goes back to the detected width */
+void print_set_screen_width(unsigned int width)
+{
+    _injected_width = width;
+}
 
-    return ws.ws_col;
+/* returns 1 if a SIGWINCH handler was installed */
+int print_enable_resize_tracking(void)
+{
+#ifdef CMDOPTIONS_ENABLE_TERM_WIDTH
+    struct sigaction action;
+    action.sa_handler = _handle_resize;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    return sigaction(SIGWINCH, &action, NULL) == 0;
 #else
-    return 80;
+    return 0;
 #endif
 }
 
-static void _print_sep(unsigned int num)
+/* ASCII white space, the same set as isspace in the "C" locale */
+static int _is_space(char ch)
 {
-    unsigned int i;
-    for(i = 0; i < num; ++i)
+    return ch == ' ' || (ch >= '\t' && ch <= '\r');
+}
+
+/* word-at-a-time check for bytes with the high bit set (that is, anything that is not ASCII) */
+static int _is_ascii(const char* str, size_t size)
+{
+    const unsigned long highbits = ((unsigned long)-1 / 255) * 0x80;
+    unsigned long word;
+    while(size >= sizeof(word))
+    {
+        memcpy(&word, str, sizeof(word));
+        if(word & highbits)
+        {
+            return 0;
+        }
+        str += sizeof(word);
+        size -= sizeof(word);
+    }
+    while(size > 0)
     {
-        putchar(' ');
+        if(*str & 0x80)
+        {
+            return 0;
+        }
+        ++str;
+        --size;
     }
+    return 1;
 }
 
-static void _put_line(const char* ch, const char* lastspace)
+/* display width of a code point: combining marks take no column, east asian wide characters take two */
+static unsigned int _codepoint_width(unsigned long cp)
 {
-    while(ch < lastspace)
+    if((cp >= 0x0300 && cp <= 0x036F) || (cp >= 0x200B && cp <= 0x200F) || (cp >= 0xFE20 && cp <= 0xFE2F))
+    {
+        return 0;
+    }
+    if((cp >= 0x1100 && cp <= 0x115F) ||
+       (cp >= 0x2E80 && cp <= 0xA4CF && cp != 0x303F) ||
+       (cp >= 0xAC00 && cp <= 0xD7A3) ||
+       (cp >= 0xF900 && cp <= 0xFAFF) ||
+       (cp >= 0xFE30 && cp <= 0xFE4F) ||
+       (cp >= 0xFF00 && cp <= 0xFF60) ||
+       (cp >= 0xFFE0 && cp <= 0xFFE6) ||
+       (cp >= 0x1F300 && cp <= 0x1F64F) ||
+       (cp >= 0x1F900 && cp <= 0x1F9FF) ||
+       (cp >= 0x20000 && cp <= 0x3FFFD))
     {
-        putchar(*ch);
-        ++ch;
+        return 2;
     }
+    return 1;
 }
 
-void print_wrapped_paragraph(const char* text, unsigned int textwidth, unsigned int leftmargin)
+/* advances over one UTF-8 sequence, invalid bytes are taken as single characters of width 1 */
+static const char* _next_character(const char* str, unsigned int* width)
 {
-    if(textwidth == 0) /* auto-width mode */
+    const unsigned char* ptr = (const unsigned char*)str;
+    unsigned long cp;
+    size_t length;
+    size_t i;
+    if(*ptr < 0x80)
     {
-        textwidth = print_get_screen_width() - leftmargin;
+        *width = 1;
+        return str + 1;
+    }
+    else if(*ptr >= 0xC2 && *ptr <= 0xDF)
+    {
+        length = 2;
+        cp = *ptr & 0x1F;
+    }
+    else if(*ptr >= 0xE0 && *ptr <= 0xEF)
+    {
+        length = 3;
+        cp = *ptr & 0x0F;
+    }
+    else if(*ptr >= 0xF0 && *ptr <= 0xF4)
+    {
+        length = 4;
+        cp = *ptr & 0x07;
+    }
+    else
+    {
+        *width = 1;
+        return str + 1;
+    }
+    for(i = 1; i < length; ++i)
+    {
+        if((ptr[i] & 0xC0) != 0x80) /* also stops at the terminating NUL */
+        {
+            *width = 1;
+            return str + 1;
+        }
+        cp = (cp << 6) | (ptr[i] & 0x3F);
+    }
+    *width = _codepoint_width(cp);
+    return str + length;
+}
+
+/*
+ * break point of a line that starts at ch and does not fit (in bytes) into textwidth + 1 columns:
+ * the last space within the first textwidth + 1 columns, otherwise the word is cut after textwidth columns
+ */
+static const char* _find_break(const char* ch, unsigned int textwidth)
+{
+    const char* lastspace = ch;
+    const char* previous = ch;
+    const char* ptr;
+    size_t column = 0;
+    unsigned int width;
+    if(_is_ascii(ch, (size_t)textwidth + 1)) /* one byte per column */
+    {
+        for(ptr = ch + textwidth; ptr > ch; --ptr)
+        {
+            if(_is_space(*ptr))
+            {
+                return ptr;
+            }
+        }
+        return textwidth > 0 ? ch + textwidth : ch + 1;
+    }
+    ptr = ch;
+    while(*ptr)
+    {
+        if(column > textwidth)
+        {
+            break;
+        }
+        if(_is_space(*ptr))
+        {
+            lastspace = ptr;
+        }
+        previous = ptr;
+        ptr = _next_character(ptr, &width);
+        column += width;
+        while(*ptr) /* keep combining characters with their base */
+        {
+            const char* next = _next_character(ptr, &width);
+            if(width > 0)
+            {
+                break;
+            }
+            ptr = next;
+        }
     }
+    if(!*ptr)
+    {
+        return ptr;
+    }
+    /* with long strings without spaces it is possible
+     * that no break point was found, fix or this goes
+     * into an endless loop */
+    if(lastspace == ch)
+    {
+        lastspace = previous > ch ? previous : ptr;
+    }
+    return lastspace;
+}
+
+void print_wrapped_paragraph_sink(struct print_sink* sink, const char* text, unsigned int textwidth, unsigned int leftmargin)
+{
     /* the first line does not indent and does not skip space characters at the beginning */
     int firstline = 1;
     /* non-printed text pointer */
     const char* ch = text;
-    while(*ch)
+    const char* end = text + strlen(text);
+    const char* lastspace;
+    if(textwidth == 0) /* auto-width mode */
+    {
+        textwidth = print_get_screen_width() - leftmargin;
+    }
+    while(ch < end)
     {
         /* skip to first non-space character (not on the first line) */
         if(!firstline)
         {
-            while(*ch && isspace(*ch))
+            while(ch < end && _is_space(*ch))
             {
                 ++ch;
             }
-        }
-        /* find last space that fits on a line */
-        const char* lastspace = ch;
-        const char* ptr = ch;
-        while(1)
-        {
-            /* end of text */
-            if(!*ptr)
-            {
-                lastspace = ptr;
-                break;
-            }
-            /* end of line (line larger than text width) */
-            if((ptr - ch) > textwidth)
+            if(ch == end)
             {
                 break;
             }
-            /* possible break point */
-            if(isspace(*ptr))
-            {
-                lastspace = ptr;
-            }
-            ++ptr;
         }
-        /* with long strings without spaces it is possible
-         * that no break point was found, fix or this goes
-         * into an endless loop */
-        if(lastspace == ch)
+        /* the rest fits on this line (a UTF-8 character never takes more columns than bytes) */
+        if((size_t)(end - ch) <= (size_t)textwidth + 1)
+        {
+            lastspace = end;
+        }
+        else
         {
-            lastspace = ptr - 1;
+            lastspace = _find_break(ch, textwidth);
         }
         /* all non-first lines are indented */
         if(!firstline)
         {
-            _print_sep(leftmargin);
+            print_sink_spaces(sink, leftmargin);
         }
         /* write line until lastspace */
-        _put_line(ch, lastspace);
-        putchar('\n');
+        print_sink_write(sink, ch, lastspace - ch);
+        print_sink_putc(sink, '\n');
         firstline = 0;
         ch = lastspace;
     }
 }
 
+void print_wrapped_paragraph_with_header_sink(struct print_sink* sink, const char* header, const char* text, unsigned int textwidth)
+{
+    print_sink_puts(sink, header);
+    print_wrapped_paragraph_sink(sink, text, textwidth, strlen(header));
+}
+
+void print_wrapped_paragraph(const char* text, unsigned int textwidth, unsigned int leftmargin)
+{
+    struct print_sink sink;
+    print_sink_init_file(&sink, stdout);
+    print_wrapped_paragraph_sink(&sink, text, textwidth, leftmargin);
+    print_sink_flush(&sink);
+    print_sink_release(&sink);
+}
+
 void print_wrapped_paragraph_with_header(const char* header, const char* text, unsigned int textwidth)
 {
-    fputs(header, stdout);
-    print_wrapped_paragraph(text, textwidth, strlen(header));
+    struct print_sink sink;
+    print_sink_init_file(&sink, stdout);
+    print_wrapped_paragraph_with_header_sink(&sink, header, text, textwidth);
+    print_sink_flush(&sink);
+    print_sink_release(&sink);
 }
 
@@ -1,8 +1,43 @@
 #ifndef PRINT_H
 #define PRINT_H
 
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * output sink: everything is collected in a buffer, which is passed on in one piece by print_sink_flush
+ * buffer sinks (no file and no callback) keep the output in data (NUL-terminated) until print_sink_release
+ */
+struct print_sink {
+    char* data;
+    size_t size;
+    size_t capacity;
+    FILE* file; /* flush target */
+    void (*callback)(void* userdata, const char* data, size_t size); /* flush target */
+    void* userdata;
+    void* (*reallocate)(void* context, void* ptr, size_t size);
+    void (*deallocate)(void* context, void* ptr);
+    void* context;
+    int valid; /* 0 if a buffer sink ran out of memory */
+};
+
+void print_sink_init_file(struct print_sink* sink, FILE* file);
+void print_sink_init_buffer(struct print_sink* sink);
+void print_sink_init_callback(struct print_sink* sink, void (*callback)(void* userdata, const char* data, size_t size), void* userdata);
+void print_sink_set_allocator(struct print_sink* sink, void* (*reallocate)(void* context, void* ptr, size_t size), void (*deallocate)(void* context, void* ptr), void* context);
+void print_sink_write(struct print_sink* sink, const char* data, size_t size);
+void print_sink_putc(struct print_sink* sink, char ch);
+void print_sink_puts(struct print_sink* sink, const char* str);
+void print_sink_spaces(struct print_sink* sink, unsigned int num);
+int print_sink_flush(struct print_sink* sink);
+void print_sink_release(struct print_sink* sink);
+
 unsigned int print_get_screen_width(void);
+void print_set_screen_width(unsigned int width);
+int print_enable_resize_tracking(void);
 void print_wrapped_paragraph(const char* text, unsigned int textwidth, unsigned int leftmargin);
 void print_wrapped_paragraph_with_header(const char* header, const char* text, unsigned int textwidth);
+void print_wrapped_paragraph_sink(struct print_sink* sink, const char* text, unsigned int textwidth, unsigned int leftmargin);
+void print_wrapped_paragraph_with_header_sink(struct print_sink* sink, const char* header, const char* text, unsigned int textwidth);
 
 #endif /* PRINT_H */
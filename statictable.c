@@ -0,0 +1,28 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "cmdoptions.h"
+
+int main(int argc, char** argv)
+{
+    int ret;
+    struct cmdoptions* cmdoptions = cmdoptions_create();
+    #include "cmdoptions_def.c"
+    if(!cmdoptions_is_valid(cmdoptions))
+    {
+        fprintf(stderr, "%s\n", "initialization of command-line options parser failed");
+        cmdoptions_exit(cmdoptions, 1);
+    }
+    /* ./generate_static_table > example_table.c, ./generate_static_table header > example_table.h */
+    if(argc > 1 && strcmp(argv[1], "header") == 0)
+    {
+        ret = cmdoptions_export_static_header(cmdoptions, "example");
+    }
+    else
+    {
+        ret = cmdoptions_export_static_table(cmdoptions, "example");
+    }
+
+    cmdoptions_destroy(cmdoptions);
+    return ret ? 0 : 1;
+}
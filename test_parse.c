@@ -0,0 +1,448 @@
+/*
+ * regression tests for the parser, run by 'make check'
+ * prints one line per failed check and exits with 1 if any check failed
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cmdoptions.h"
+
+#define RESPONSE_FILE "test_parse.rsp"
+#define BATCH_FILE "test_parse.batch"
+
+static int _failures = 0;
+
+#define CHECK(condition) _check(condition, #condition, __LINE__)
+
+static void _check(int condition, const char* text, int line)
+{
+    if(!condition)
+    {
+        printf("test_parse.c:%d: check failed: %s\n", line, text);
+        _failures += 1;
+    }
+}
+
+static void _write_file(const char* path, const char* content)
+{
+    FILE* f = fopen(path, "wb");
+    if(f)
+    {
+        fputs(content, f);
+        fclose(f);
+    }
+}
+
+static struct cmdoptions* _define(void)
+{
+    struct cmdoptions* options = cmdoptions_create();
+    cmdoptions_add_option(options, 'v', "verbose", NO_ARG, "verbose");
+    cmdoptions_add_option(options, 'n', "number", SINGLE_ARG, "number");
+    cmdoptions_enable_response_files(options);
+    return options;
+}
+
+struct events {
+    int verbose;
+    char number[16];
+};
+
+static int _collect(const struct cmdoptions_event* event, void* userdata)
+{
+    struct events* events = userdata;
+    if(event->type == CMDOPTIONS_EVENT_OPTION && event->short_identifier == 'v')
+    {
+        events->verbose = 1;
+    }
+    else if(event->type == CMDOPTIONS_EVENT_OPTION && event->short_identifier == 'n')
+    {
+        strncpy(events->number, event->value, sizeof(events->number) - 1);
+    }
+    return 1;
+}
+
+/* a short option cluster at the end of a response file takes its argument from argv, the file is finished meanwhile */
+static void _test_cluster_at_end_of_response_file(void)
+{
+    static const char* argv[] = { "prog", "@" RESPONSE_FILE, "foo" };
+    struct events events = { 0, "" };
+    struct cmdoptions* options;
+    _write_file(RESPONSE_FILE, "-vn\n");
+
+    options = _define();
+    CHECK(cmdoptions_parse(options, 3, argv));
+    CHECK(cmdoptions_was_provided_short(options, 'v'));
+    CHECK(cmdoptions_get_argument_short(options, 'n') && strcmp(cmdoptions_get_argument_short(options, 'n'), "foo") == 0);
+    CHECK(cmdoptions_get_positional_count(options) == 0);
+    cmdoptions_destroy(options);
+
+    options = _define();
+    cmdoptions_enable_borrowed_arguments(options);
+    CHECK(cmdoptions_parse(options, 3, argv));
+    CHECK(cmdoptions_get_argument_short(options, 'n') && strcmp(cmdoptions_get_argument_short(options, 'n'), "foo") == 0);
+    cmdoptions_destroy(options);
+
+    options = _define();
+    CHECK(cmdoptions_parse_events(options, 3, argv, _collect, &events));
+    CHECK(events.verbose && strcmp(events.number, "foo") == 0);
+    cmdoptions_destroy(options);
+
+    remove(RESPONSE_FILE);
+}
+
+/* a static table (or snapshot) with an argument type that does not exist is rejected */
+static void _test_unknown_argument_type(void)
+{
+    static const unsigned long seeds[] = { 0 };
+    static const int slots[] = { -1 };
+    static const struct cmdoptions_static_entry entries[] = {
+        { CMDOPTIONS_STATIC_OPTION, 'x', "extra", SINGLE_ARG | 0x70, NULL, "extra", -1, 0 }
+    };
+    int short_table[256];
+    struct cmdoptions_static_mode mode;
+    struct cmdoptions_static_table table;
+    int i;
+    for(i = 0; i < 256; ++i)
+    {
+        short_table[i] = -1;
+    }
+    mode.identifier = NULL;
+    mode.entries = entries;
+    mode.size = 1;
+    mode.first_entry = 0;
+    mode.short_table = short_table;
+    mode.long_hash.seeds = seeds;
+    mode.long_hash.seeds_size = 1;
+    mode.long_hash.slots = slots;
+    mode.long_hash.slots_size = 1;
+    table.modes = &mode;
+    table.size = 1;
+    table.mode_hash = mode.long_hash;
+    table.entries = 1;
+    table.prehelpmsg = "";
+    table.posthelpmsg = "";
+    table.help = NULL;
+    table.help_size = 0;
+    table.manpage = NULL;
+    CHECK(cmdoptions_create_static(&table) == NULL);
+}
+
+/* a multiple typed option that was not given returns its default as an array of one value */
+static void _test_multiple_typed_default(void)
+{
+    static const char* argv[] = { "prog", "--level", "3", "--level", "4" };
+    struct cmdoptions* options = cmdoptions_create();
+    const long* levels;
+    const double* ratios;
+    cmdoptions_add_option_default(options, 'l', "level", MULTI_ARGS | INT_ARG, "7", "level");
+    cmdoptions_add_option_default(options, 'r', "ratio", MULTI_ARGS | DOUBLE_ARG, "0.5", "ratio");
+    CHECK(cmdoptions_parse(options, 1, argv));
+    levels = cmdoptions_get_argument_long(options, "level");
+    ratios = cmdoptions_get_argument_long(options, "ratio");
+    CHECK(cmdoptions_get_argument_count_long(options, "level") == 1 && levels && levels[0] == 7);
+    CHECK(cmdoptions_get_argument_count_long(options, "ratio") == 1 && ratios && ratios[0] == 0.5);
+    cmdoptions_reset(options);
+    CHECK(cmdoptions_parse(options, 5, argv));
+    levels = cmdoptions_get_argument_long(options, "level");
+    CHECK(cmdoptions_get_argument_count_long(options, "level") == 2 && levels && levels[0] == 3 && levels[1] == 4);
+    cmdoptions_destroy(options);
+}
+
+struct typed_events {
+    long level;
+    int errors;
+};
+
+static int _collect_typed(const struct cmdoptions_event* event, void* userdata)
+{
+    struct typed_events* events = userdata;
+    if(event->type == CMDOPTIONS_EVENT_OPTION && event->typed_value)
+    {
+        events->level = *(const long*)event->typed_value;
+    }
+    else if(event->type == CMDOPTIONS_EVENT_ERROR)
+    {
+        events->errors += 1;
+    }
+    return 1;
+}
+
+/* events of typed options carry the converted value, invalid values are error events */
+static void _test_typed_events(void)
+{
+    static const char* valid[] = { "prog", "--level", "42" };
+    static const char* invalid[] = { "prog", "--level", "many" };
+    struct typed_events events = { 0, 0 };
+    struct cmdoptions* options = cmdoptions_create();
+    cmdoptions_add_option(options, 'l', "level", SINGLE_ARG | INT_ARG, "level");
+    CHECK(cmdoptions_parse_events(options, 3, valid, _collect_typed, &events));
+    CHECK(events.level == 42 && events.errors == 0);
+    CHECK(!cmdoptions_parse_events(options, 3, invalid, _collect_typed, &events));
+    CHECK(events.level == 42 && events.errors == 1);
+    cmdoptions_destroy(options);
+}
+
+static int _stop_at_second_line(struct cmdoptions_result* result, size_t line, int parsed, void* userdata)
+{
+    (void)result;
+    (void)parsed;
+    *(size_t*)userdata = line;
+    return line < 2;
+}
+
+/* a batch stopped by its callback is told apart from a failed one */
+static void _test_batch_stop(void)
+{
+    struct cmdoptions* options = _define();
+    size_t line = 0;
+    cmdoptions_freeze(options);
+    _write_file(BATCH_FILE, "-v\n-n 1\n-n 2\n");
+    CHECK(cmdoptions_parse_batch(options, BATCH_FILE, 1, CMDOPTIONS_BATCH_ORDERED, _stop_at_second_line, &line) == CMDOPTIONS_BATCH_STOPPED);
+    CHECK(line == 2);
+    _write_file(BATCH_FILE, "-v\n");
+    CHECK(cmdoptions_parse_batch(options, BATCH_FILE, 1, CMDOPTIONS_BATCH_ORDERED, _stop_at_second_line, &line) == 1);
+    remove(BATCH_FILE);
+    cmdoptions_destroy(options);
+}
+
+/* allocator hooks that fail exactly one allocation, counted from 1 (0: none) */
+struct failing_allocator {
+    unsigned long count;
+    unsigned long fail_at;
+};
+
+static void* _failing_allocate(void* context, size_t size)
+{
+    struct failing_allocator* allocator = context;
+    return ++allocator->count == allocator->fail_at ? NULL : malloc(size);
+}
+
+static void* _failing_reallocate(void* context, void* ptr, size_t size)
+{
+    struct failing_allocator* allocator = context;
+    return ++allocator->count == allocator->fail_at ? NULL : realloc(ptr, size);
+}
+
+static void _failing_deallocate(void* context, void* ptr)
+{
+    (void)context;
+    free(ptr);
+}
+
+struct lookup_events {
+    int options;
+    int errors;
+};
+
+static int _count_events(const struct cmdoptions_event* event, void* userdata)
+{
+    struct lookup_events* events = userdata;
+    if(event->type == CMDOPTIONS_EVENT_OPTION)
+    {
+        events->options += 1;
+    }
+    else if(event->type == CMDOPTIONS_EVENT_ERROR)
+    {
+        events->errors += 1;
+    }
+    return 1;
+}
+
+/* an option whose long identifier did not fit into the index is gone, it can not be found by its short identifier either */
+static void _test_failed_add_option(void)
+{
+    static const char* argv[] = { "prog", "-x" };
+    static const char* names[] = { "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf" };
+    struct failing_allocator failing;
+    struct cmdoptions_allocator allocator;
+    struct lookup_events events;
+    struct cmdoptions* options;
+    size_t defined;
+    size_t i;
+    unsigned long offset;
+    int added;
+    int failed = 0;
+    allocator.allocate = _failing_allocate;
+    allocator.reallocate = _failing_reallocate;
+    allocator.deallocate = _failing_deallocate;
+    allocator.context = &failing;
+    for(defined = 0; defined <= sizeof(names) / sizeof(*names); ++defined) /* the index grows at different sizes */
+    {
+        for(offset = 1; offset <= 8; ++offset)
+        {
+            failing.count = 0;
+            failing.fail_at = 0;
+            options = cmdoptions_create_with_allocator(&allocator);
+            if(!options)
+            {
+                CHECK(options != NULL);
+                return;
+            }
+            for(i = 0; i < defined; ++i)
+            {
+                cmdoptions_add_option(options, NO_SHORT, names[i], NO_ARG, "option");
+            }
+            failing.fail_at = failing.count + offset;
+            added = cmdoptions_add_option(options, 'x', "xray", NO_ARG, "option");
+            failing.fail_at = 0;
+            events.options = 0;
+            events.errors = 0;
+            cmdoptions_parse_events(options, 2, argv, _count_events, &events);
+            if(added)
+            {
+                CHECK(events.options == 1 && events.errors == 0);
+            }
+            else
+            {
+                failed += 1;
+                CHECK(events.options == 0 && events.errors == 1);
+            }
+            cmdoptions_destroy(options);
+        }
+    }
+    CHECK(failed > 0);
+}
+
+/* 'a' and "alpha" are defined twice, the alias 'l'/"lima" points to "alpha", the mode "build" has its own 'a'/"alpha" */
+static struct cmdoptions* _define_lookups(void)
+{
+    struct cmdoptions* options = cmdoptions_create();
+    cmdoptions_add_option(options, 'a', "alpha", SINGLE_ARG, "first");
+    cmdoptions_add_option(options, 'a', "apple", SINGLE_ARG, "same short identifier");
+    cmdoptions_add_option(options, 'b', "alpha", SINGLE_ARG, "same long identifier");
+    cmdoptions_add_alias(options, "alpha", 'l', "lima", "alias");
+    cmdoptions_add_mode(options, "build");
+    cmdoptions_mode_add_option(options, "build", 'a', "alpha", SINGLE_ARG, "mode option");
+    return options;
+}
+
+static int _is(const char* argument, const char* expected)
+{
+    return expected ? argument && strcmp(argument, expected) == 0 : !argument;
+}
+
+/* parses argv and checks the arguments seen through every identifier */
+static void _check_lookups(int argc, const char** argv, const char* alpha, const char* apple, const char* bravo, const char* build_alpha)
+{
+    struct cmdoptions* options = _define_lookups();
+    CHECK(cmdoptions_parse(options, argc, argv));
+    CHECK(_is(cmdoptions_get_argument_short(options, 'a'), alpha));
+    CHECK(_is(cmdoptions_get_argument_long(options, "alpha"), alpha));
+    CHECK(_is(cmdoptions_get_argument_short(options, 'l'), alpha));
+    CHECK(_is(cmdoptions_get_argument_long(options, "lima"), alpha));
+    CHECK(_is(cmdoptions_get_argument_long(options, "apple"), apple));
+    CHECK(_is(cmdoptions_get_argument_short(options, 'b'), bravo));
+    CHECK(_is(cmdoptions_mode_get_argument_short(options, "build", 'a'), build_alpha));
+    CHECK(_is(cmdoptions_mode_get_argument_long(options, "build", "alpha"), build_alpha));
+    cmdoptions_destroy(options);
+}
+
+/* the indexed lookups find what the linear search found: the first registration of an identifier, the target of an alias, and only the options of the selected mode */
+static void _test_indexed_lookups(void)
+{
+    static const char* short_first[] = { "prog", "-a", "1" };
+    static const char* long_first[] = { "prog", "--alpha", "2" };
+    static const char* short_alias[] = { "prog", "-l", "3" };
+    static const char* long_alias[] = { "prog", "--lima", "4" };
+    static const char* shadowed[] = { "prog", "--apple", "5", "-b", "6" };
+    static const char* mode[] = { "prog", "build", "-a", "7" };
+    static const char* base_in_mode[] = { "prog", "build", "--apple", "8" };
+    struct cmdoptions* options;
+    struct lookup_events events;
+    _check_lookups(3, short_first, "1", NULL, NULL, NULL);
+    _check_lookups(3, long_first, "2", NULL, NULL, NULL);
+    _check_lookups(3, short_alias, "3", NULL, NULL, NULL);
+    _check_lookups(3, long_alias, "4", NULL, NULL, NULL);
+    _check_lookups(5, shadowed, NULL, "5", "6", NULL);
+    _check_lookups(4, mode, NULL, NULL, NULL, "7");
+    options = _define_lookups();
+    memset(&events, 0, sizeof(events));
+    CHECK(!cmdoptions_parse_events(options, 4, base_in_mode, _count_events, &events));
+    CHECK(events.options == 0 && events.errors == 1);
+    cmdoptions_destroy(options);
+}
+
+/* 'n' has a default, 'i' collects arguments, the mode "build" has an option 'a' */
+static int _define_reset(struct cmdoptions* options)
+{
+    return options &&
+        cmdoptions_add_option_default(options, 'n', "number", SINGLE_ARG, "5", "number") &&
+        cmdoptions_add_option(options, 'i', "include", MULTI_ARGS, "include") &&
+        cmdoptions_add_mode(options, "build") &&
+        cmdoptions_mode_add_option(options, "build", 'a', "all", NO_ARG, "all");
+}
+
+/* after a reset, nothing of the previous command line is left, and repeated parses take no further storage */
+static void _check_reset(struct cmdoptions* options)
+{
+    static const char* argv[] = { "prog", "build", "-a", "p1", "p2", "p3", "p4", "p5", "p6", "p7", "p8", "p9", "p10", "p11", "p12", "p13", "p14", "p15", "p16", "p17" };
+    static const char* base[] = { "prog", "-n", "7", "-i", "x", "-i", "y", "z" };
+    static const char* help[] = { "prog", "-h" };
+    size_t used;
+    int round;
+    CHECK(_define_reset(options));
+    if(!options)
+    {
+        return;
+    }
+    used = cmdoptions_get_storage_used(options);
+    for(round = 0; round < 3; ++round)
+    {
+        CHECK(cmdoptions_parse(options, 20, argv));
+        CHECK(cmdoptions_mode_was_provided_short(options, "build", 'a'));
+        CHECK(!cmdoptions_mode_no_args_given(options, "build"));
+        CHECK(cmdoptions_get_positional_count(options) == 17);
+        cmdoptions_reset(options);
+        CHECK(!cmdoptions_mode_was_provided_short(options, "build", 'a'));
+        CHECK(cmdoptions_no_args_given(options));
+        CHECK(cmdoptions_get_positional_count(options) == 0);
+        CHECK(!cmdoptions_get_positional_parameter(options, 0));
+        CHECK(cmdoptions_get_storage_used(options) == used);
+
+        CHECK(cmdoptions_parse(options, 8, base));
+        CHECK(_is(cmdoptions_get_argument_short(options, 'n'), "7"));
+        CHECK(cmdoptions_get_argument_count_short(options, 'i') == 2);
+        CHECK(_is(cmdoptions_get_positional_parameter(options, 0), "z"));
+        cmdoptions_reset(options);
+        CHECK(!cmdoptions_was_provided_short(options, 'n'));
+        CHECK(_is(cmdoptions_get_argument_short(options, 'n'), "5"));
+        CHECK(!cmdoptions_was_provided_short(options, 'i'));
+        CHECK(cmdoptions_get_argument_count_short(options, 'i') == 0);
+        CHECK(cmdoptions_get_storage_used(options) == used);
+
+        CHECK(cmdoptions_parse(options, 2, help));
+        CHECK(cmdoptions_help_passed(options));
+        cmdoptions_reset(options);
+        CHECK(!cmdoptions_help_passed(options));
+        CHECK(cmdoptions_is_valid(options));
+        CHECK(cmdoptions_get_storage_used(options) == used);
+    }
+    cmdoptions_destroy(options);
+}
+
+static void _test_reset(void)
+{
+    static char storage[16384];
+    _check_reset(cmdoptions_create());
+    _check_reset(cmdoptions_create_with_arena());
+    _check_reset(cmdoptions_create_with_storage(storage, sizeof(storage)));
+}
+
+int main(void)
+{
+    _test_cluster_at_end_of_response_file();
+    _test_unknown_argument_type();
+    _test_multiple_typed_default();
+    _test_typed_events();
+    _test_batch_stop();
+    _test_failed_add_option();
+    _test_indexed_lookups();
+    _test_reset();
+    if(_failures)
+    {
+        printf("%d checks failed\n", _failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,316 @@
+/*
+ * tests for the paragraph wrapper, run by 'make check'
+ * prints one line per failed check and exits with 1 if any check failed
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "print.h"
+
+static int _failures = 0;
+
+#define CHECK(condition) _check(condition, #condition, __LINE__)
+
+static void _check(int condition, const char* text, int line)
+{
+    if(!condition)
+    {
+        printf("test_print.c:%d: check failed: %s\n", line, text);
+        _failures += 1;
+    }
+}
+
+/* the wrapper before it learned UTF-8, one byte per column (loops on trailing white space and at width 0) */
+static void _reference_wrap(struct print_sink* sink, const char* text, unsigned int textwidth, unsigned int leftmargin)
+{
+    int firstline = 1;
+    const char* ch = text;
+    const char* lastspace;
+    const char* ptr;
+    while(*ch)
+    {
+        if(!firstline)
+        {
+            while(*ch && (*ch == ' ' || (*ch >= '\t' && *ch <= '\r')))
+            {
+                ++ch;
+            }
+        }
+        lastspace = ch;
+        ptr = ch;
+        while(1)
+        {
+            if(!*ptr)
+            {
+                lastspace = ptr;
+                break;
+            }
+            if((size_t)(ptr - ch) > textwidth)
+            {
+                break;
+            }
+            if(*ptr == ' ' || (*ptr >= '\t' && *ptr <= '\r'))
+            {
+                lastspace = ptr;
+            }
+            ++ptr;
+        }
+        if(lastspace == ch)
+        {
+            lastspace = ptr - 1;
+        }
+        if(!firstline)
+        {
+            print_sink_spaces(sink, leftmargin);
+        }
+        print_sink_write(sink, ch, lastspace - ch);
+        print_sink_putc(sink, '\n');
+        firstline = 0;
+        ch = lastspace;
+    }
+}
+
+/* returns the wrapped text, to be freed */
+static char* _wrap(const char* text, unsigned int textwidth, unsigned int leftmargin)
+{
+    struct print_sink sink;
+    char* result;
+    print_sink_init_buffer(&sink);
+    print_wrapped_paragraph_sink(&sink, text, textwidth, leftmargin);
+    result = malloc(sink.size + 1);
+    if(!result)
+    {
+        printf("out of memory\n");
+        exit(1);
+    }
+    memcpy(result, sink.data ? sink.data : "", sink.size);
+    result[sink.size] = '\0';
+    print_sink_release(&sink);
+    return result;
+}
+
+static int _wraps_to(const char* text, unsigned int textwidth, unsigned int leftmargin, const char* expected)
+{
+    char* result = _wrap(text, textwidth, leftmargin);
+    int equal = strcmp(result, expected) == 0;
+    if(!equal)
+    {
+        printf("wrapping \"%s\" at %u: got \"%s\", expected \"%s\"\n", text, textwidth, result, expected);
+    }
+    free(result);
+    return equal;
+}
+
+/* deterministic pseudo random numbers, the same on every platform */
+static unsigned long _random_state = 1;
+
+static unsigned int _random(unsigned int range)
+{
+    _random_state = (_random_state * 1103515245UL + 12345UL) & 0x7fffffffUL;
+    return (unsigned int)((_random_state >> 16) % range);
+}
+
+/* ASCII text without white space at the beginning and the end, which the old wrapper does not handle */
+static void _random_ascii(char* text, size_t size)
+{
+    static const char* spaces = " \t\n";
+    size_t length = 0;
+    size_t word = 0;
+    size_t target = 1 + _random(size - 1);
+    while(length < target)
+    {
+        if(word > 0 && length + 1 < target && _random(6) == 0)
+        {
+            text[length++] = spaces[_random(3)];
+            word = 0;
+        }
+        else
+        {
+            text[length++] = (char)('a' + _random(26));
+            word += 1;
+        }
+    }
+    text[length] = '\0';
+}
+
+static void _test_ascii_matches_reference(void)
+{
+    char text[200];
+    struct print_sink sink;
+    char* result;
+    unsigned int textwidth;
+    unsigned int leftmargin;
+    int i;
+    int mismatches = 0;
+    for(i = 0; i < 20000; ++i)
+    {
+        _random_ascii(text, sizeof(text));
+        textwidth = 1 + _random(40);
+        leftmargin = _random(5);
+        result = _wrap(text, textwidth, leftmargin);
+        print_sink_init_buffer(&sink);
+        _reference_wrap(&sink, text, textwidth, leftmargin);
+        if(strcmp(result, sink.data) != 0)
+        {
+            if(mismatches++ == 0)
+            {
+                printf("wrapping \"%s\" at %u: got \"%s\", expected \"%s\"\n", text, textwidth, result, sink.data);
+            }
+        }
+        print_sink_release(&sink);
+        free(result);
+    }
+    CHECK(mismatches == 0);
+}
+
+static void _test_examples(void)
+{
+    /* east asian wide characters take two columns and are never split (as in the ASCII wrapper, the last line may take the column after textwidth) */
+    CHECK(_wraps_to("\xe6\x97\xa5\xe6\x9c\xac \xe8\xaa\x9e\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e", 5, 0, "\xe6\x97\xa5\xe6\x9c\xac\n\xe8\xaa\x9e\xe6\x97\xa5\n\xe6\x9c\xac\xe8\xaa\x9e\n"));
+    CHECK(_wraps_to("\xe6\x97\xa5\xe6\x97\xa5\xe6\x97\xa5\xe6\x97\xa5", 3, 0, "\xe6\x97\xa5\n\xe6\x97\xa5\n\xe6\x97\xa5\xe6\x97\xa5\n"));
+    /* combining marks take no column and stay with their base character */
+    CHECK(_wraps_to("e\xcc\x81" "e\xcc\x81" "e\xcc\x81" "e\xcc\x81" "e\xcc\x81" "e\xcc\x81", 3, 0, "e\xcc\x81" "e\xcc\x81" "e\xcc\x81\n" "e\xcc\x81" "e\xcc\x81" "e\xcc\x81\n"));
+    CHECK(_wraps_to("ab e\xcc\x81" "e\xcc\x81" "e\xcc\x81", 4, 0, "ab\ne\xcc\x81" "e\xcc\x81" "e\xcc\x81\n"));
+    /* invalid bytes take one column each, a truncated sequence is not glued to what follows */
+    CHECK(_wraps_to("\xff\xfe\xfd\xfc\xfb", 3, 0, "\xff\xfe\xfd\n\xfc\xfb\n"));
+    CHECK(_wraps_to("abc\xe6\x97x", 3, 0, "abc\n\xe6\x97x\n"));
+    /* trailing white space after a wrapped line is dropped, it used to write a negative length */
+    CHECK(_wraps_to("aaaa bbbb   ", 4, 0, "aaaa\nbbbb\n"));
+    CHECK(_wraps_to("aaaa bbbb \n\t", 4, 2, "aaaa\n  bbbb\n"));
+    CHECK(_wraps_to("aaa  ", 10, 0, "aaa  \n"));
+    CHECK(_wraps_to("", 10, 0, ""));
+    /* a width of 0 (screen width equal to the margin) still advances by one character, it used to loop */
+    print_set_screen_width(2);
+    CHECK(_wraps_to("ab \xe6\x97\xa5", 0, 2, "a\n  b\n  \xe6\x97\xa5\n"));
+    print_set_screen_width(0);
+}
+
+/* the pieces of the random UTF-8 text and their display widths */
+static const char* _units[] = { "a", "\xc3\xa9", "e\xcc\x81", "\xe6\x97\xa5", "\xf0\x9f\x98\x80" };
+static const unsigned int _unit_widths[] = { 1, 1, 1, 2, 2 };
+
+/* display width of a line made of whole units and spaces, -1 if a unit is split */
+static int _line_width(const char* line, size_t size, int* units)
+{
+    int width = 0;
+    size_t length;
+    size_t u;
+    *units = 0;
+    while(size > 0)
+    {
+        if(*line == ' ')
+        {
+            width += 1;
+            line += 1;
+            size -= 1;
+            continue;
+        }
+        for(u = 0; u < sizeof(_units) / sizeof(*_units); ++u)
+        {
+            length = strlen(_units[u]);
+            if(length <= size && memcmp(line, _units[u], length) == 0)
+            {
+                break;
+            }
+        }
+        if(u == sizeof(_units) / sizeof(*_units))
+        {
+            return -1;
+        }
+        width += _unit_widths[u];
+        *units += 1;
+        line += length;
+        size -= length;
+    }
+    return width;
+}
+
+/* appends the non-space bytes of str */
+static size_t _strip_spaces(char* target, const char* str, size_t size)
+{
+    size_t length = 0;
+    size_t i;
+    for(i = 0; i < size; ++i)
+    {
+        if(str[i] != ' ' && str[i] != '\n')
+        {
+            target[length++] = str[i];
+        }
+    }
+    return length;
+}
+
+static void _test_utf8_properties(void)
+{
+    char text[400];
+    char expected[400];
+    char found[400];
+    size_t expected_length;
+    size_t found_length;
+    size_t length;
+    char* result;
+    const char* line;
+    const char* newline;
+    unsigned int textwidth;
+    int width;
+    int units;
+    int i;
+    int split = 0;
+    int overlong = 0;
+    int lost = 0;
+    for(i = 0; i < 20000; ++i)
+    {
+        length = 0;
+        while(length < 300)
+        {
+            strcpy(text + length, _units[_random(sizeof(_units) / sizeof(*_units))]);
+            length += strlen(text + length);
+            if(_random(5) == 0)
+            {
+                text[length++] = _random(4) ? ' ' : '\n';
+            }
+        }
+        text[length] = '\0';
+        textwidth = 1 + _random(30);
+        result = _wrap(text, textwidth, 0);
+        expected_length = _strip_spaces(expected, text, length);
+        found_length = 0;
+        for(line = result; *line; line = newline + 1)
+        {
+            newline = strchr(line, '\n');
+            width = _line_width(line, newline - line, &units);
+            found_length += _strip_spaces(found + found_length, line, newline - line);
+            if(width < 0)
+            {
+                split += 1;
+            }
+            /* like the ASCII wrapper, the last line may take the column after textwidth (two for a wide character) */
+            else if(width > (int)textwidth + (newline[1] ? 0 : 2) && units > 1)
+            {
+                overlong += 1;
+            }
+        }
+        if(found_length != expected_length || memcmp(found, expected, found_length) != 0)
+        {
+            lost += 1;
+        }
+        free(result);
+    }
+    CHECK(split == 0);
+    CHECK(overlong == 0);
+    CHECK(lost == 0);
+}
+
+int main(void)
+{
+    _test_ascii_matches_reference();
+    _test_examples();
+    _test_utf8_properties();
+    if(_failures)
+    {
+        printf("%d checks failed\n", _failures);
+        return 1;
+    }
+    return 0;
+}